@@ -40,9 +40,35 @@ ApplicationWindow {
                 GraphView {
                     id: graph
                     objectName: "graph"
+                    clip: true   // the world is unbounded; only draw inside the item
                     width: parent.width * 0.85   // larger default width
                     height: parent.height * 0.7
                 }
+                Text {
+                    id: layoutStatus
+                    anchors.left: graph.left
+                    anchors.top: graph.bottom
+                    color: "grey"
+                    text: graph.simulationState === GraphView.Sleeping ? "Layout at rest" : "Layout running"
+                }
+                Button {
+                    id: relayoutButton
+                    anchors.left: layoutStatus.right
+                    anchors.leftMargin: 10
+                    anchors.verticalCenter: layoutStatus.verticalCenter
+                    text: "Re-layout"
+                    onClicked: graph.relayout()
+                }
+                ComboBox {
+                    anchors.left: relayoutButton.right
+                    anchors.leftMargin: 10
+                    anchors.verticalCenter: layoutStatus.verticalCenter
+                    width: 200
+                    // Same order as GraphView.LayoutAlgorithm
+                    model: ["Springs", "Fruchterman-Reingold", "ForceAtlas2", "Stress majorization"]
+                    currentIndex: graph.layoutAlgorithm
+                    onActivated: (index) => graph.layoutAlgorithm = index
+                }
             }
         }
 
@@ -73,6 +99,9 @@ ApplicationWindow {
                 Layout.preferredWidth: 350
                 Layout.fillHeight: true
                 model: sessionArtistModel
+                // Read from the DB when a row is clicked; the session itself
+                // only keeps ids, names and release titles.
+                property var details: ({})
 
                 delegate: Rectangle {
                     width: ListView.view ? ListView.view.width : 0
@@ -88,6 +117,9 @@ ApplicationWindow {
                             Layout.fillWidth: true
                             elide: Text.ElideRight
                             verticalAlignment: Text.AlignVCenter
+                            TapHandler {
+                                onTapped: artistList.details = artistService.artistDetailsMap(artistId)
+                            }
                         }
 
                         Button {
@@ -104,6 +136,25 @@ ApplicationWindow {
                     }
                 }
             }
+
+            ScrollView {
+                Layout.preferredWidth: 350
+                Layout.preferredHeight: 200
+                visible: artistList.details.id !== undefined
+
+                TextArea {
+                    readOnly: true
+                    wrapMode: TextEdit.Wrap
+                    text: {
+                        const d = artistList.details
+                        if (d.id === undefined) return ""
+                        let lines = [d.name, d.resourceUrl, "", d.profile, ""]
+                        for (const r of d.releases)
+                            lines.push((r.year ? r.year + "  " : "") + r.title + (r.role ? " (" + r.role + ")" : ""))
+                        return lines.join("\n")
+                    }
+                }
+            }
         }
     }
 }
@@ -1,4 +1,37 @@
 #include "artist.h"
+#include <algorithm>
+
+ReleaseSet intersectReleases(const ReleaseSet& a, const ReleaseSet& b)
+{
+    const ReleaseSet& small = a.size() <= b.size() ? a : b;
+    const ReleaseSet& large = a.size() <= b.size() ? b : a;
+    ReleaseSet shared;
+    if (small.isEmpty()) return shared;
+
+    // Below this size ratio a plain merge touches fewer elements than galloping.
+    constexpr qsizetype gallopRatio = 8;
+    if (large.size() < small.size() * gallopRatio) {
+        std::set_intersection(small.cbegin(), small.cend(), large.cbegin(), large.cend(),
+                              std::back_inserter(shared));
+        return shared;
+    }
+
+    auto pos = large.cbegin();
+    const auto end = large.cend();
+    for (ReleaseKey release : small) {
+        // Double the stride until it passes release, then bisect the last stride.
+        qsizetype step = 1;
+        auto probe = pos;
+        while (end - probe > step && probe[step] < release) {
+            probe += step;
+            step *= 2;
+        }
+        pos = std::lower_bound(probe, end - probe > step ? probe + step + 1 : end, release);
+        if (pos == end) break;
+        if (*pos == release) shared.append(release);
+    }
+    return shared;
+}
 
 QDebug operator<<(QDebug dbg, const ReleaseInfo &r)
 {
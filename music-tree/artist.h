@@ -4,9 +4,12 @@
 #pragma once
 
 #include <QString>
+#include <QVector>
+#include <functional>
 #include <ostream>
 #include <vector>
 #include <QDebug>
+#include "persistentmap.h"
 
 struct ReleaseInfo {
     QString id;
@@ -31,10 +34,16 @@ struct Artist {
 };
 
 
+// Artist and release ids interned by the session (see IdTable). Within the
+// session and the graph, artists and releases are referred to by these;
+// the Discogs id strings are only used towards the UI, the DB and the API.
+using ArtistKey = quint32;
+using ReleaseKey = quint32;
+
 struct CollabKey {
-    QString a, b;
+    ArtistKey a, b;
 
-    CollabKey(const QString& id1, const QString& id2) {
+    CollabKey(ArtistKey id1, ArtistKey id2) {
         if (id1 < id2) { a = id1; b = id2; }
         else           { a = id2; b = id1; }
     }
@@ -46,13 +55,47 @@ struct CollabKey {
 
 struct CollabKeyHash {
     std::size_t operator()(const CollabKey& k) const {
-        return qHash(k.a) ^ (qHash(k.b) << 1);
+        return std::hash<quint64>()((quint64(k.a) << 32) | k.b);
     }
 };
 
-using ArtistCollaboration = QVector<QString>; // list of shared releases
+// Release keys in ascending order, without duplicates.
+using ReleaseSet = QVector<ReleaseKey>;
+
+using ArtistCollaboration = ReleaseSet; // shared releases
+
+// Releases in both sets. Merges sets of similar size and gallops through the
+// larger one otherwise, so a prolific artist against a small one costs about
+// min * log(max) rather than the size of the prolific catalogue.
+ReleaseSet intersectReleases(const ReleaseSet& a, const ReleaseSet& b);
+
+// Both keys packed side by side, so distinct pairs never share bits.
+struct CollabKeyBits {
+    quint64 operator()(const CollabKey& k) const { return (quint64(k.a) << 32) | k.b; }
+};
 
-using SessionCollaborations = std::unordered_map<CollabKey, ArtistCollaboration, CollabKeyHash>;
+// Copies share structure (see PersistentMap), so the session can hand one
+// out with every snapshot without copying the edges.
+using SessionCollaborations = PersistentMap<CollabKey, ArtistCollaboration, CollabKeyBits>;
+
+// The edges one session change added or removed, weight being the number
+// of shared releases. generation is the SessionSnapshot the change leads
+// to; the previous one is generation - 1. A pair's weight only changes
+// with an artist's releases, and the session never changes those in
+// place (refreshing an artist removes and re-adds it), so there is no
+// re-weighted list: such a pair comes as removed and then added.
+struct CollabEdge {
+    CollabKey key;
+    int weight;
+};
+
+struct CollabDelta {
+    quint64 generation = 0;
+    QVector<CollabEdge> added;
+    QVector<CollabKey> removed;
+
+    bool isEmpty() const { return added.isEmpty() && removed.isEmpty(); }
+};
 
 
 
@@ -21,6 +21,7 @@ ArtistService::ArtistService(QObject* parent) : QObject(parent){
 
 void ArtistService::clearDb(void) {
     m_db.clear();
+    emit dbCleared();
 }
 
 // Public: Search by name
@@ -135,19 +136,29 @@ void ArtistService::loadArtistsFromFile() {
     QJsonObject root = doc.object();
     QJsonArray artistArray = root["artists"].toArray();
 
+    // Artists already cached in the DB go into the session as one batch;
+    // the rest are searched on Discogs and arrive one by one.
+    std::vector<Artist> cached;
     for (const QJsonValue &value : std::as_const(artistArray)) {
         if (!value.isObject()) continue;
 
         QJsonObject artistObj = value.toObject();
-        // QString id = artistObj["id"].toString();
+        QString id = artistObj["id"].toString();
         QString name = artistObj["name"].toString();
 
+        if (!id.isEmpty()) {
+            auto artistOpt = m_db.findArtistById(id);
+            if (artistOpt.has_value()) {
+                cached.push_back(std::move(*artistOpt));
+                continue;
+            }
+        }
         if (!name.isEmpty()) {
             searchByName(name);
-            // optionally you could check if ID already exists in local DB,
-            // or fetch by ID if that's more reliable than by name
         }
     }
+    qDebug() << "Loaded" << cached.size() << "cached artist(s) from file";
+    m_session.addArtists(cached);
 }
 void ArtistService::saveArtistsToFile() {
     QString fileName = QFileDialog::getSaveFileName(nullptr,
@@ -159,7 +170,8 @@ void ArtistService::saveArtistsToFile() {
     }
 
     QJsonArray artistArray;
-    for (const auto &artist : sessionArtists()) {
+    for (int row = 0; row < m_session.artistCount(); ++row) {
+        const Artist& artist = m_session.artistAt(row);
         QJsonObject artistObj;
         artistObj["id"] = artist.id;       // assuming you have id and name fields
         artistObj["name"] = artist.name;
@@ -185,11 +197,56 @@ void ArtistService::removeSessionArtistById(const QString& artistId) {
 }
 
 void ArtistService::refreshSessionArtist(const QString& artistId) {
-    QString artistName = m_session.getArtistById(artistId)->name;
+    const Artist* artist = m_session.getArtistById(artistId);
+    if (!artist) return;
+    QString artistName = artist->name;
     m_session.removeArtistById(artistId);
     m_db.removeArtistById(artistId);
 
     searchByName(artistName);
 }
 
+std::optional<Artist> ArtistService::artistDetails(const QString& artistId) const {
+    return m_db.findArtistById(artistId);
+}
+
+std::optional<ReleaseInfo> ArtistService::releaseDetails(const QString& releaseId) const {
+    return m_db.findReleaseById(releaseId);
+}
+
+static QVariantMap releaseToMap(const ReleaseInfo& release) {
+    return {
+        {"id", release.id},
+        {"title", release.title},
+        {"year", release.year},
+        {"country", release.country},
+        {"genre", release.genre},
+        {"style", release.style},
+        {"resourceUrl", release.resourceUrl},
+        {"dataQuality", release.dataQuality},
+        {"role", release.role},
+    };
+}
 
+QVariantMap ArtistService::artistDetailsMap(const QString& artistId) const {
+    const auto artist = artistDetails(artistId);
+    if (!artist) return {};
+
+    QVariantList releases;
+    releases.reserve(qsizetype(artist->releases.size()));
+    for (const ReleaseInfo& release : artist->releases) {
+        releases.append(releaseToMap(release));
+    }
+    return {
+        {"id", artist->id},
+        {"name", artist->name},
+        {"profile", artist->profile},
+        {"resourceUrl", artist->resourceUrl},
+        {"releases", releases},
+    };
+}
+
+QVariantMap ArtistService::releaseDetailsMap(const QString& releaseId) const {
+    const auto release = releaseDetails(releaseId);
+    return release ? releaseToMap(*release) : QVariantMap();
+}
@@ -2,6 +2,7 @@
 
 #include <QString>
 #include <QFuture>
+#include <QVariantMap>
 #include <optional>
 #include <vector>
 #include "artist.h"
@@ -26,16 +27,28 @@ public:
     Q_INVOKABLE void removeSessionArtistById(const QString& artistId);
     Q_INVOKABLE void refreshSessionArtist(const QString& artistId);
 
+    // Details the session does not keep (profile, URLs, the releases' full
+    // fields), read from the DB when the UI asks. Empty if not cached.
+    std::optional<Artist> artistDetails(const QString& artistId) const;
+    std::optional<ReleaseInfo> releaseDetails(const QString& releaseId) const;
+    Q_INVOKABLE QVariantMap artistDetailsMap(const QString& artistId) const;
+    Q_INVOKABLE QVariantMap releaseDetailsMap(const QString& releaseId) const;
+
 
     // TODO: Consider if these should be accessible through ArtistService or not:
     SessionManager *sessionManager() {
         return &m_session;
     }
-    const QVector<Artist>& sessionArtists() const {
-        return m_session.artists();
+    SessionSnapshotPtr sessionSnapshot() const {
+        return m_session.snapshot();
+    }
+
+    // Graph layout positions cached in the DB, keyed by artist id
+    QHash<QString, QPointF> layoutPositions() const {
+        return m_db.loadLayoutPositions();
     }
-    const SessionCollaborations& collabs() const {
-        return m_session.collabs();
+    void saveLayoutPositions(const QHash<QString, QPointF>& positions) {
+        m_db.saveLayoutPositions(positions);
     }
 
 
@@ -44,6 +57,7 @@ public:
 signals:
     void artistFound(const Artist& artist);                     // UI list update
     void collaborationsReady(const QMap<QString, std::vector<QString>>& collabs); // UI graph update
+    void dbCleared();
 
 
 private slots:
@@ -0,0 +1,121 @@
+#include "barneshut.h"
+#include <algorithm>
+#include <cmath>
+
+void BarnesHutTree::build(const double* x, const double* y, int count, const double* mass) {
+    m_cells.clear();
+    m_bodyLeaf.assign(count, -1);
+    m_x = x;
+    m_y = y;
+    m_mass = mass;
+    if (count <= 0) return;
+
+    double minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+    for (int i = 1; i < count; ++i) {
+        minX = std::min(minX, x[i]);
+        maxX = std::max(maxX, x[i]);
+        minY = std::min(minY, y[i]);
+        maxY = std::max(maxY, y[i]);
+    }
+
+    // Square root cell, padded slightly so bodies on the border fall inside.
+    const double half = std::max(maxX - minX, maxY - minY) / 2.0 + 1.0;
+    m_cells.reserve(count * 2);
+    makeCell((minX + maxX) / 2.0, (minY + maxY) / 2.0, half);
+
+    for (int i = 0; i < count; ++i) {
+        insert(i);
+    }
+}
+
+int BarnesHutTree::makeCell(double cx, double cy, double half) {
+    Cell cell;
+    cell.cx = cx;
+    cell.cy = cy;
+    cell.half = half;
+    m_cells.push_back(cell);
+    return int(m_cells.size()) - 1;
+}
+
+int BarnesHutTree::quadrantFor(const Cell& cell, double px, double py) const {
+    return (px >= cell.cx ? 1 : 0) | (py >= cell.cy ? 2 : 0);
+}
+
+void BarnesHutTree::insert(int body) {
+    const double px = m_x[body];
+    const double py = m_y[body];
+    const double m = massOf(body);
+
+    int idx = 0;
+    for (int depth = 0; ; ++depth) {
+        // Note: m_cells may reallocate below, so always index, never hold references.
+        const bool isLeaf = m_cells[idx].child[0] < 0;
+
+        if (isLeaf && m_cells[idx].mass == 0.0) {
+            Cell& leaf = m_cells[idx];
+            leaf.body = body;
+            leaf.mass = m;
+            leaf.sumX = px * m;
+            leaf.sumY = py * m;
+            m_bodyLeaf[body] = idx;
+            return;
+        }
+
+        if (isLeaf && depth >= maxDepth) {
+            Cell& leaf = m_cells[idx];
+            leaf.mass += m;
+            leaf.sumX += px * m;
+            leaf.sumY += py * m;
+            m_bodyLeaf[body] = idx;
+            return;
+        }
+
+        if (isLeaf) {
+            // Split the leaf and push its current body one level down.
+            const double q = m_cells[idx].half / 2.0;
+            const double cx = m_cells[idx].cx;
+            const double cy = m_cells[idx].cy;
+            for (int c = 0; c < 4; ++c) {
+                const int child = makeCell(cx + ((c & 1) ? q : -q),
+                                           cy + ((c & 2) ? q : -q), q);
+                m_cells[idx].child[c] = child;
+            }
+
+            const int existing = m_cells[idx].body;
+            m_cells[idx].body = -1;
+            const int target = m_cells[idx].child[quadrantFor(m_cells[idx], m_x[existing], m_y[existing])];
+            Cell& moved = m_cells[target];
+            moved.body = existing;
+            moved.mass = m_cells[idx].mass;
+            moved.sumX = m_cells[idx].sumX;
+            moved.sumY = m_cells[idx].sumY;
+            m_bodyLeaf[existing] = target;
+        }
+
+        Cell& cell = m_cells[idx];
+        cell.mass += m;
+        cell.sumX += px * m;
+        cell.sumY += py * m;
+        idx = cell.child[quadrantFor(cell, px, py)];
+    }
+}
+
+void BarnesHutTree::accumulateForce(int self, double strength, double theta,
+                                    double& fx, double& fy) const {
+    if (m_cells.empty()) return;
+    accumulate(m_x[self], m_y[self], m_bodyLeaf[self], massOf(self), strength, theta, fx, fy);
+}
+
+void BarnesHutTree::accumulateForceAt(double px, double py, double strength, double theta,
+                                      double& fx, double& fy) const {
+    if (m_cells.empty()) return;
+    accumulate(px, py, -1, 0.0, strength, theta, fx, fy);
+}
+
+void BarnesHutTree::accumulate(double px, double py, int selfLeaf, double selfMass,
+                               double strength, double theta, double& fx, double& fy) const {
+    traverse(px, py, selfLeaf, selfMass, theta, [strength](double d2, double mass) {
+        const double dist = std::max(1.0, std::sqrt(d2));
+        return mass * strength / (dist * dist * dist);
+    }, fx, fy);
+}
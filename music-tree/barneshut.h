@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+
+// Quadtree over node positions used to approximate the all-pairs repulsion
+// in O(n log n). Each cell stores the mass and mass-weighted position sum of
+// the bodies below it; a cell whose width/distance ratio is below theta acts
+// as a single body placed at its centre of mass.
+class BarnesHutTree {
+public:
+    // mass may be null, in which case every body weighs 1.
+    void build(const double* x, const double* y, int count, const double* mass = nullptr);
+
+    // Adds the repulsion acting on body 'self' to (fx, fy).
+    // Uses the same inverse-square model as the exact pass: strength / dist^2
+    // per unit of source mass, with dist clamped to at least 1.
+    void accumulateForce(int self, double strength, double theta,
+                         double& fx, double& fy) const;
+
+    // Same for a point that is not one of the tree's bodies.
+    void accumulateForceAt(double px, double py, double strength, double theta,
+                           double& fx, double& fy) const;
+
+    // Same traversal for any central force law. law(d2, mass) returns the
+    // factor the separation from a source of that mass is scaled by, so
+    // (fx, fy) += (dx, dy) * law(d2, mass). Inlined into the caller, so each
+    // layout model gets its own specialized loop.
+    template <typename Law>
+    void accumulateWith(int self, double theta, const Law& law, double& fx, double& fy) const {
+        if (m_cells.empty()) return;
+        traverse(m_x[self], m_y[self], m_bodyLeaf[self], massOf(self), theta, law, fx, fy);
+    }
+
+    bool isEmpty() const { return m_cells.empty(); }
+
+private:
+    struct Cell {
+        double cx = 0.0, cy = 0.0; // geometric centre of the cell
+        double half = 0.0;         // half the side length
+        double mass = 0.0;         // total mass of the bodies below this cell
+        double sumX = 0.0, sumY = 0.0;
+        int child[4] = {-1, -1, -1, -1};
+        int body = -1;             // first body stored in a leaf
+    };
+
+    void insert(int body);
+    double massOf(int body) const { return m_mass ? m_mass[body] : 1.0; }
+    int makeCell(double cx, double cy, double half);
+    int quadrantFor(const Cell& cell, double px, double py) const;
+    void accumulate(double px, double py, int selfLeaf, double selfMass,
+                    double strength, double theta, double& fx, double& fy) const;
+    template <typename Law>
+    void traverse(double px, double py, int selfLeaf, double selfMass,
+                  double theta, const Law& law, double& fx, double& fy) const;
+
+    // Coincident bodies stop subdividing here and are merged into one leaf.
+    static constexpr int maxDepth = 32;
+
+    std::vector<Cell> m_cells;
+    std::vector<int> m_bodyLeaf; // leaf cell holding each body
+    const double* m_x = nullptr;
+    const double* m_y = nullptr;
+    const double* m_mass = nullptr;
+};
+
+template <typename Law>
+void BarnesHutTree::traverse(double px, double py, int selfLeaf, double selfMass,
+                             double theta, const Law& law, double& fx, double& fy) const {
+    const double theta2 = theta * theta;
+
+    int stack[4 * maxDepth + 4];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const int idx = stack[--top];
+        const Cell& cell = m_cells[idx];
+        if (cell.mass == 0.0) continue;
+
+        double mass = cell.mass;
+        double sumX = cell.sumX;
+        double sumY = cell.sumY;
+        const bool isLeaf = cell.child[0] < 0;
+
+        if (isLeaf && idx == selfLeaf) {
+            // Exclude the body itself from its own leaf.
+            mass -= selfMass;
+            if (mass <= 1e-12 * selfMass) continue;
+            sumX -= px * selfMass;
+            sumY -= py * selfMass;
+        }
+
+        const double dx = px - sumX / mass;
+        const double dy = py - sumY / mass;
+        const double d2 = dx * dx + dy * dy;
+        const double width = cell.half * 2.0;
+
+        if (isLeaf || width * width < theta2 * d2) {
+            const double factor = law(d2, mass);
+            fx += dx * factor;
+            fy += dy * factor;
+            continue;
+        }
+
+        for (int c = 0; c < 4; ++c) {
+            stack[top++] = cell.child[c];
+        }
+    }
+}
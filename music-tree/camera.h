@@ -0,0 +1,28 @@
+#pragma once
+#include <QPointF>
+#include <QRectF>
+#include <QSizeF>
+#include <QtGlobal>
+
+// View transform of the graph: screen = world * scale + offset.
+// The simulation works in unbounded world coordinates; only the camera
+// decides which part of the world ends up inside the item.
+struct Camera {
+    double scale = 1.0;
+    QPointF offset;
+
+    QPointF toScreen(const QPointF& world) const { return world * scale + offset; }
+    QPointF toWorld(const QPointF& screen) const { return (screen - offset) / scale; }
+
+    // World-space rectangle visible in an item of the given size.
+    QRectF visibleWorld(const QSizeF& viewSize) const {
+        return QRectF(toWorld(QPointF(0, 0)), toWorld(QPointF(viewSize.width(), viewSize.height())));
+    }
+
+    // Zooms by 'factor' keeping the world point under 'screenAnchor' fixed.
+    void zoomAt(const QPointF& screenAnchor, double factor, double minScale, double maxScale) {
+        const QPointF world = toWorld(screenAnchor);
+        scale = qBound(minScale, scale * factor, maxScale);
+        offset = screenAnchor - world * scale;
+    }
+};
@@ -41,6 +41,11 @@ bool DatabaseManager::initialize() {
 
     return initializeSchema();
 }
+
+// Version of resources/schema.sql, kept in the DB's user_version. A DB
+// created from an older schema is brought up to date by migrateSchema().
+static constexpr int schemaVersion = 1;
+
 bool DatabaseManager::initializeSchema() {
     QSqlDatabase db = getThreadConnection();
     QSqlQuery check(db);
@@ -59,17 +64,48 @@ bool DatabaseManager::initializeSchema() {
         QString schema = schemaFile.readAll();
         schemaFile.close();
 
-        QStringList statements = schema.split(';', Qt::SkipEmptyParts);
-        for (const QString& stmt : std::as_const(statements)) {
-            QString trimmed = stmt.trimmed();
-            if (trimmed.isEmpty()) continue;
+        return execStatements(db, schema)
+            && execStatements(db, QString("PRAGMA user_version = %1").arg(schemaVersion));
+    }
 
-            QSqlQuery query(db);
-            if (!query.exec(trimmed)) {
-                qWarning() << "Schema creation failed:" << query.lastError().text()
-                << "\nStatement:" << trimmed;
-                return false;
-            }
+    QSqlQuery version(db);
+    if (!version.exec("PRAGMA user_version") || !version.next()) {
+        qWarning() << "Failed to read schema version:" << version.lastError().text();
+        return false;
+    }
+    const int current = version.value(0).toInt();
+    return current >= schemaVersion || migrateSchema(db, current);
+}
+
+// One step per schema version, each ending with the version it reached, so
+// an interrupted migration resumes where it stopped.
+bool DatabaseManager::migrateSchema(QSqlDatabase& db, int fromVersion) {
+    if (fromVersion < 1) {
+        // Last layout position of each artist
+        const bool ok = execStatements(db, R"(
+            CREATE TABLE IF NOT EXISTS layout_positions (
+                artist_id TEXT PRIMARY KEY,
+                x REAL NOT NULL,
+                y REAL NOT NULL
+            );
+            PRAGMA user_version = 1
+        )");
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::execStatements(QSqlDatabase& db, const QString& statements) {
+    const QStringList list = statements.split(';', Qt::SkipEmptyParts);
+    for (const QString& stmt : list) {
+        QString trimmed = stmt.trimmed();
+        if (trimmed.isEmpty()) continue;
+
+        QSqlQuery query(db);
+        if (!query.exec(trimmed)) {
+            qWarning() << "Schema creation failed:" << query.lastError().text()
+            << "\nStatement:" << trimmed;
+            return false;
         }
     }
     return true;
@@ -190,6 +226,35 @@ std::vector<ReleaseInfo> DatabaseManager::getReleasesForArtist(const QString& ar
     return releases;
 }
 
+std::optional<ReleaseInfo> DatabaseManager::findReleaseById(const QString& releaseId) const {
+    QSqlDatabase db = getThreadConnection();
+    QSqlQuery query(db);
+    query.prepare(R"(
+        SELECT id, title, year, country, genre, style, resource_url, data_quality
+        FROM releases
+        WHERE id = :id
+    )");
+    query.bindValue(":id", releaseId);
+
+    if (!query.exec()) {
+        qWarning() << "findReleaseById failed:" << query.lastError().text();
+        return std::nullopt;
+    }
+
+    if (query.next()) {
+        ReleaseInfo info;
+        info.id = query.value(0).toString();
+        info.title = query.value(1).toString();
+        info.year = query.value(2).toInt();
+        info.country = query.value(3).toString();
+        info.genre = query.value(4).toString();
+        info.style = query.value(5).toString();
+        info.resourceUrl = query.value(6).toString();
+        info.dataQuality = query.value(7).toString();
+        return info;
+    }
+    return std::nullopt;
+}
 
 // -----------------------------
 // Insert or update
@@ -390,7 +455,8 @@ void DatabaseManager::clear() {
         "release_artists",
         "releases",
         "members",
-        "artists"
+        "artists",
+        "layout_positions"
     };
 
     for (const QString &table : tables) {
@@ -412,6 +478,65 @@ void DatabaseManager::clear() {
 }
 
 
+// -----------------------------
+// Layout positions
+// -----------------------------
+QHash<QString, QPointF> DatabaseManager::loadLayoutPositions() const {
+    QHash<QString, QPointF> positions;
+    QSqlDatabase db = getThreadConnection();
+    QSqlQuery query(db);
+
+    if (!query.exec("SELECT artist_id, x, y FROM layout_positions")) {
+        qWarning() << "loadLayoutPositions failed:" << query.lastError().text();
+        return positions;
+    }
+
+    while (query.next()) {
+        positions.insert(query.value(0).toString(),
+                         QPointF(query.value(1).toDouble(), query.value(2).toDouble()));
+    }
+    return positions;
+}
+
+void DatabaseManager::saveLayoutPositions(const QHash<QString, QPointF>& positions) {
+    if (positions.isEmpty()) return;
+
+    // One transaction for the whole batch; row by row a 2,000 artist session
+    // would take seconds to write.
+    QSqlDatabase db = getThreadConnection();
+    if (!db.transaction()) {
+        qWarning() << "Failed to start transaction:" << db.lastError().text();
+        return;
+    }
+
+    QSqlQuery query(db);
+    query.prepare(R"(
+        INSERT INTO layout_positions (artist_id, x, y)
+        VALUES (:artist_id, :x, :y)
+        ON CONFLICT(artist_id) DO UPDATE SET
+            x = excluded.x,
+            y = excluded.y
+    )");
+
+    for (auto it = positions.cbegin(); it != positions.cend(); ++it) {
+        query.bindValue(":artist_id", it.key());
+        query.bindValue(":x", it.value().x());
+        query.bindValue(":y", it.value().y());
+        if (!query.exec()) {
+            qWarning() << "saveLayoutPositions failed:" << query.lastError().text()
+            << "Artist ID:" << it.key();
+            db.rollback();
+            return;
+        }
+    }
+
+    if (!db.commit()) {
+        qWarning() << "Transaction commit failed:" << db.lastError().text();
+        db.rollback();
+    }
+}
+
+
 // -----------------------------
 // Collaborations
 // -----------------------------
@@ -8,7 +8,9 @@
 #include <QDir>
 #include <QVariant>
 #include <QDebug>
+#include <QHash>
 #include <QMap>
+#include <QPointF>
 #include <QString>
 #include <QThread>
 #include <QFile>
@@ -36,6 +38,8 @@ public:
     std::optional<Artist> findArtistById(const QString& artistId) const;
 
     std::vector<ReleaseInfo> getReleasesForArtist(const QString& artistId) const;
+    // Release fields only; role and artistName depend on the artist and stay empty.
+    std::optional<ReleaseInfo> findReleaseById(const QString& releaseId) const;
 
     // Save or update artist in DB
     void saveArtist(const Artist& artist);
@@ -55,6 +59,10 @@ public:
     // Clear all data
     void clear();
 
+    // Graph layout position per artist id
+    QHash<QString, QPointF> loadLayoutPositions() const;
+    void saveLayoutPositions(const QHash<QString, QPointF>& positions);
+
 
 
 
@@ -64,6 +72,8 @@ private:
 
     // Initialization helpers
     bool initializeSchema();
+    bool migrateSchema(QSqlDatabase& db, int fromVersion);
+    static bool execStatements(QSqlDatabase& db, const QString& statements);
 
     // Transaction-aware overloads
     bool deleteArtistFromReleases(QSqlDatabase& db, const QString& artistId);
@@ -0,0 +1,149 @@
+// Checks every force kernel table this CPU supports against the scalar
+// reference on the same inputs, and times them. Built only with
+// -DMUSIC_TREE_KERNEL_CHECK=ON; exits non-zero if a kernel disagrees.
+#include "forcekernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace ForceKernels;
+
+namespace {
+
+// Summation order differs between tables, so results are compared relative
+// to the largest magnitude of the reference output.
+constexpr double tolerance = 1e-9;
+
+struct Inputs {
+    std::vector<double> x, y, vx, vy;
+    std::vector<int> edgeA, edgeB;
+};
+
+Inputs makeInputs(int n, int edges) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> pos(-2000.0, 2000.0);
+    std::uniform_real_distribution<double> vel(-5.0, 5.0);
+    std::uniform_int_distribution<int> node(0, n - 1);
+
+    Inputs in;
+    for (int i = 0; i < n; ++i) {
+        in.x.push_back(pos(rng));
+        in.y.push_back(pos(rng));
+        in.vx.push_back(vel(rng));
+        in.vy.push_back(vel(rng));
+    }
+    // Some coincident and near-coincident nodes, to hit the distance clamp.
+    for (int i = 0; i + 1 < n && i < 16; i += 2) {
+        in.x[i + 1] = in.x[i] + (i % 4 ? 0.0 : 0.25);
+        in.y[i + 1] = in.y[i];
+    }
+    for (int e = 0; e < edges; ++e) {
+        const int a = node(rng);
+        int b = node(rng);
+        if (b == a) b = (a + 1) % n;
+        in.edgeA.push_back(a);
+        in.edgeB.push_back(b);
+    }
+    return in;
+}
+
+double maxAbs(const std::vector<double>& v) {
+    double m = 0.0;
+    for (double d : v) m = std::max(m, std::abs(d));
+    return m;
+}
+
+// Largest difference relative to the reference's largest magnitude.
+double relativeError(const std::vector<double>& ref, const std::vector<double>& got) {
+    double err = 0.0;
+    for (size_t i = 0; i < ref.size(); ++i) err = std::max(err, std::abs(ref[i] - got[i]));
+    return err / std::max(1.0, maxAbs(ref));
+}
+
+// Best of a few runs, in milliseconds.
+double timeMs(const std::function<void()>& fn, int runs = 5) {
+    double best = 1e300;
+    for (int r = 0; r < runs; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+struct Outputs {
+    std::vector<double> fx, fy;      // repulse
+    std::vector<double> svx, svy;    // springs
+    std::vector<double> ix, iy, ivx, ivy; // integrate
+};
+
+Outputs run(const KernelTable& table, const Inputs& in) {
+    const int n = int(in.x.size());
+    Outputs out;
+    out.fx.assign(n, 0.0);
+    out.fy.assign(n, 0.0);
+    table.repulse(in.x.data(), in.y.data(), n, 0, n, 1500.0, out.fx.data(), out.fy.data());
+
+    out.svx = in.vx;
+    out.svy = in.vy;
+    table.springs(in.x.data(), in.y.data(), in.edgeA.data(), in.edgeB.data(), int(in.edgeA.size()),
+                  0.02, 120.0, out.svx.data(), out.svy.data());
+
+    out.ix = in.x;
+    out.iy = in.y;
+    out.ivx = in.vx;
+    out.ivy = in.vy;
+    table.integrate(out.ix.data(), out.iy.data(), out.ivx.data(), out.ivy.data(), n, 0.85,
+                    -1500.0, 1500.0, -1500.0, 1500.0);
+    return out;
+}
+
+} // namespace
+
+int main() {
+    // An odd count, so every vector width has a scalar tail.
+    const int n = 4099;
+    const Inputs in = makeInputs(n, 3 * n);
+    const KernelTable& scalar = *forIsa(Isa::Scalar);
+    const Outputs ref = run(scalar, in);
+
+    std::vector<double> fx(n), fy(n);
+    const auto timeRepulse = [&](const KernelTable& table) {
+        return timeMs([&] {
+            std::fill(fx.begin(), fx.end(), 0.0);
+            std::fill(fy.begin(), fy.end(), 0.0);
+            table.repulse(in.x.data(), in.y.data(), n, 0, n, 1500.0, fx.data(), fy.data());
+        });
+    };
+    const double scalarMs = timeRepulse(scalar);
+
+    bool ok = true;
+    std::printf("%-8s %12s %12s %12s %10s %8s\n", "table", "repulse err", "springs err", "integr. err", "repulse", "speedup");
+    for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2}) {
+        const KernelTable* table = forIsa(isa);
+        if (!table) {
+            std::printf("%-8s not supported by this build/CPU\n", isa == Isa::Sse2 ? "sse2" : "avx2");
+            continue;
+        }
+        const Outputs got = run(*table, in);
+        const double repulseErr = std::max(relativeError(ref.fx, got.fx), relativeError(ref.fy, got.fy));
+        const double springsErr = std::max(relativeError(ref.svx, got.svx), relativeError(ref.svy, got.svy));
+        const double integrateErr = std::max({relativeError(ref.ix, got.ix), relativeError(ref.iy, got.iy),
+                                              relativeError(ref.ivx, got.ivx), relativeError(ref.ivy, got.ivy)});
+        const double ms = timeRepulse(*table);
+        std::printf("%-8s %12.2e %12.2e %12.2e %8.2fms %7.2fx\n", table->name, repulseErr, springsErr,
+                    integrateErr, ms, scalarMs / ms);
+
+        if (repulseErr > tolerance || springsErr > tolerance || integrateErr > tolerance) {
+            std::printf("  FAILED: %s differs from scalar by more than %g\n", table->name, tolerance);
+            ok = false;
+        }
+    }
+    std::printf("best(): %s\n", best().name);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// Vectorized inner loops of the force layout.
+// Each instruction set provides the same three kernels; the best one the CPU
+// supports is picked once at runtime. All variants compute the same model as
+// the scalar reference and agree with it up to floating point rounding.
+namespace ForceKernels {
+
+enum class Isa { Scalar, Sse2, Avx2 };
+
+struct KernelTable {
+    Isa isa;
+    const char* name;
+
+    // Adds the repulsion acting on targets [begin, end) from all n sources:
+    // strength / dist^2 along the separation, dist clamped to at least 1.
+    // A node's contribution to itself is zero, so no self check is needed.
+    void (*repulse)(const double* x, const double* y, int n, int begin, int end,
+                    double strength, double* fx, double* fy);
+
+    // Edge springs: strength * (dist - length), pulling a towards b and b towards a.
+    void (*springs)(const double* x, const double* y, const int* edgeA, const int* edgeB,
+                    int edgeCount, double strength, double length, double* vx, double* vy);
+
+    // pos += vel; vel *= damping; pos clamped to [min, max] per axis.
+    void (*integrate)(double* x, double* y, double* vx, double* vy, int n, double damping,
+                      double minX, double maxX, double minY, double maxY);
+};
+
+// Fastest table supported by this CPU (detected once).
+const KernelTable& best();
+
+// Table for a specific instruction set, or nullptr if this build/CPU lacks it.
+const KernelTable* forIsa(Isa isa);
+
+} // namespace ForceKernels
@@ -0,0 +1,269 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "barneshut.h"
+#include "forcepool.h"
+#include "layoutengine.h"
+
+// Edge weight policies: how strongly a collaboration pulls (or, for stress,
+// how much it shortens the edge) given the number of shared releases.
+struct UnitEdgeWeight {
+    static double weight(double) { return 1.0; }
+};
+
+// Grows with the shared releases but slowly, so one prolific duo does not
+// collapse onto itself.
+struct LogEdgeWeight {
+    static double weight(double sharedReleases) { return 1.0 + std::log(std::max(1.0, sharedReleases)); }
+};
+
+// Force policies for ForceLayout. Each one provides
+//   name, degreeMass        whether nodes weigh degree + 1 (else 1)
+//   Constants constants(p)  model constants derived from LayoutParams
+//   repulsion(c, d2)        factor on the separation per unit of both masses
+//   attraction(c, dist)     factor on the separation of an edge, before its weight
+//   gravity(c, x, y, m, fx, fy)
+//   restart(n, p, topologyChanged), move(store, fx, fy, mass, p)
+// The last two are members: a model may keep state between steps.
+
+// Step limit that starts at maxStep whenever the simulation is restarted
+// and cools geometrically, so a model without damping still comes to rest.
+struct CoolingSchedule {
+    static constexpr double cooling = 0.97;
+    double temperature = 0.0;
+
+    void restart(const LayoutParams& p) { temperature = p.maxStep; }
+    void cool() { temperature *= cooling; }
+};
+
+// Fruchterman-Reingold: repulsion k^2/d, attraction d^2/k, and every node
+// moves along its force by at most the current temperature.
+struct FruchtermanReingoldForces {
+    static constexpr const char* name = "Fruchterman-Reingold";
+    static constexpr bool degreeMass = false;
+
+    struct Constants { double k2, invK, gravity; };
+    static Constants constants(const LayoutParams& p) {
+        return {p.springLength * p.springLength, 1.0 / p.springLength, p.gravity * gravityScale};
+    }
+    static double repulsion(const Constants& c, double d2) { return c.k2 / std::max(1.0, d2); }
+    static double attraction(const Constants& c, double dist) { return dist * c.invK; }
+    static void gravity(const Constants& c, double x, double y, double, double& fx, double& fy) {
+        fx -= c.gravity * x;
+        fy -= c.gravity * y;
+    }
+
+    void restart(int, const LayoutParams& p, bool) { schedule.restart(p); }
+    void move(LayoutStore& store, const std::vector<double>& fx, const std::vector<double>& fy,
+              const std::vector<double>&, const LayoutParams&) {
+        for (int i = 0; i < store.size(); ++i) {
+            double dx = fx[i], dy = fy[i];
+            capStep(dx, dy, schedule.temperature);
+            store.x[i] += dx;
+            store.y[i] += dy;
+            store.vx[i] = dx;
+            store.vy[i] = dy;
+        }
+        schedule.cool();
+    }
+
+    // LayoutParams::gravity is tuned for the Springs model, whose forces
+    // are orders of magnitude weaker.
+    static constexpr double gravityScale = 2000.0;
+    CoolingSchedule schedule;
+};
+
+// ForceAtlas2 (Jacomy et al.): nodes weigh degree + 1 and repel in
+// proportion to both masses over distance, edges pull linearly, and each
+// node's speed adapts to how much its force swings between steps, so hubs
+// calm down while the periphery still moves fast. On its own FA2 keeps
+// jittering under the Barnes-Hut approximation, so steps are also capped by
+// a cooling schedule like Fruchterman-Reingold's.
+struct ForceAtlas2Forces {
+    static constexpr const char* name = "ForceAtlas2";
+    static constexpr bool degreeMass = true;
+
+    // kr is chosen so two connected leaves (mass 2 each) rest springLength apart.
+    struct Constants { double kr, gravity; };
+    static Constants constants(const LayoutParams& p) {
+        return {p.springLength * p.springLength / 4.0, p.gravity * gravityScale};
+    }
+    static double repulsion(const Constants& c, double d2) { return c.kr / std::max(1.0, d2); }
+    static double attraction(const Constants&, double) { return 1.0; }
+    static void gravity(const Constants& c, double x, double y, double mass, double& fx, double& fy) {
+        fx -= c.gravity * mass * x;
+        fy -= c.gravity * mass * y;
+    }
+
+    void restart(int n, const LayoutParams& p, bool topologyChanged) {
+        // Previous forces are per index, which a topology change may reuse.
+        if (topologyChanged || int(prevFx.size()) != n) {
+            prevFx.assign(n, 0.0);
+            prevFy.assign(n, 0.0);
+        }
+        speed = 1.0;
+        schedule.restart(p);
+    }
+    void move(LayoutStore& store, const std::vector<double>& fx, const std::vector<double>& fy,
+              const std::vector<double>& mass, const LayoutParams&) {
+        const int n = store.size();
+        prevFx.resize(n, 0.0);
+        prevFy.resize(n, 0.0);
+
+        double swingSum = 0.0, tractionSum = 0.0;
+        for (int i = 0; i < n; ++i) {
+            swingSum += mass[i] * std::hypot(fx[i] - prevFx[i], fy[i] - prevFy[i]);
+            tractionSum += mass[i] * std::hypot(fx[i] + prevFx[i], fy[i] + prevFy[i]) / 2.0;
+        }
+        if (swingSum > 0.0) {
+            speed = std::min(jitterTolerance * tractionSum / swingSum, maxRise * speed);
+        }
+
+        for (int i = 0; i < n; ++i) {
+            const double swing = std::hypot(fx[i] - prevFx[i], fy[i] - prevFy[i]);
+            const double nodeSpeed = localSpeed * speed / (1.0 + speed * std::sqrt(swing));
+            double dx = fx[i] * nodeSpeed, dy = fy[i] * nodeSpeed;
+            capStep(dx, dy, schedule.temperature);
+            store.x[i] += dx;
+            store.y[i] += dy;
+            store.vx[i] = dx;
+            store.vy[i] = dy;
+        }
+        prevFx = fx;
+        prevFy = fy;
+        schedule.cool();
+    }
+
+    static constexpr double gravityScale = 2000.0;
+    static constexpr double jitterTolerance = 1.0;
+    static constexpr double maxRise = 1.5;     // global speed grows at most this much per step
+    static constexpr double localSpeed = 0.1;
+    double speed = 1.0;
+    CoolingSchedule schedule;
+    std::vector<double> prevFx, prevFy;
+};
+
+// Force directed layout with the force laws and the edge weighting fixed at
+// compile time. Repulsion is exact pairwise up to barnesHutThreshold nodes
+// and a mass-weighted Barnes-Hut approximation above; both, and the
+// attraction, are split over the force pool.
+template <typename ForcePolicy, typename EdgeWeightPolicy>
+class ForceLayout final : public LayoutEngine {
+public:
+    explicit ForceLayout(ForcePool& pool) : m_pool(pool) {}
+
+    const char* name() const override { return ForcePolicy::name; }
+
+    void restart(const LayoutStore& store, const LayoutParams& params, bool topologyChanged) override {
+        if (topologyChanged || int(m_mass.size()) != store.size()) {
+            m_mass.assign(store.size(), 1.0);
+            if (ForcePolicy::degreeMass) {
+                for (int e = 0; e < store.edgeCount(); ++e) {
+                    m_mass[store.edgeA[e]] += 1.0;
+                    m_mass[store.edgeB[e]] += 1.0;
+                }
+            }
+        }
+        m_forces.restart(store.size(), params, topologyChanged);
+    }
+
+    void step(LayoutStore& store, const LayoutParams& params) override {
+        const int n = store.size();
+        const double* x = store.x.data();
+        const double* y = store.y.data();
+        const typename ForcePolicy::Constants c = ForcePolicy::constants(params);
+        m_fx.assign(n, 0.0);
+        m_fy.assign(n, 0.0);
+        m_mass.resize(n, 1.0);
+
+        // Repulsion
+        if (n > params.barnesHutThreshold) {
+            m_tree.build(x, y, n, ForcePolicy::degreeMass ? m_mass.data() : nullptr);
+            const auto law = [&c](double d2, double mass) { return ForcePolicy::repulsion(c, d2) * mass; };
+            m_pool.forBlocks(n, treeBlock, [&](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    double fx = 0.0, fy = 0.0;
+                    m_tree.accumulateWith(i, params.theta, law, fx, fy);
+                    m_fx[i] += fx * m_mass[i];
+                    m_fy[i] += fy * m_mass[i];
+                }
+            });
+        } else if (m_pool.threadCount() == 1) {
+            // Each pair once, applied to both ends.
+            for (int i = 0; i < n; ++i) {
+                for (int j = i + 1; j < n; ++j) {
+                    const double dx = x[i] - x[j];
+                    const double dy = y[i] - y[j];
+                    const double f = ForcePolicy::repulsion(c, dx * dx + dy * dy) * m_mass[i] * m_mass[j];
+                    m_fx[i] += dx * f;
+                    m_fy[i] += dy * f;
+                    m_fx[j] -= dx * f;
+                    m_fy[j] -= dy * f;
+                }
+            }
+        } else {
+            // Every node sums all pairs into its own force, twice the work of
+            // the loop above but with nothing shared, so node blocks can go to
+            // whichever thread is free, as SpringLayout does.
+            m_pool.forBlocks(n, exactBlock, [&](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    double fx = 0.0, fy = 0.0;
+                    for (int j = 0; j < n; ++j) {
+                        if (j == i) continue;
+                        const double dx = x[i] - x[j];
+                        const double dy = y[i] - y[j];
+                        const double f = ForcePolicy::repulsion(c, dx * dx + dy * dy) * m_mass[j];
+                        fx += dx * f;
+                        fy += dy * f;
+                    }
+                    m_fx[i] += fx * m_mass[i];
+                    m_fy[i] += fy * m_mass[i];
+                }
+            });
+        }
+
+        // Attraction, per thread over its own slice of the edges.
+        const auto attract = [&](int begin, int end, double* fx, double* fy) {
+            for (int e = begin; e < end; ++e) {
+                const int a = store.edgeA[e], b = store.edgeB[e];
+                const double dx = x[a] - x[b];
+                const double dy = y[a] - y[b];
+                const double dist = std::sqrt(dx * dx + dy * dy);
+                const double f = ForcePolicy::attraction(c, dist) * EdgeWeightPolicy::weight(store.edgeWeight[e]);
+                fx[a] -= dx * f;
+                fy[a] -= dy * f;
+                fx[b] += dx * f;
+                fy[b] += dy * f;
+            }
+        };
+        if (m_pool.threadCount() == 1) {
+            attract(0, store.edgeCount(), m_fx.data(), m_fy.data());
+        } else {
+            m_edgeForces.reset(m_pool.threadCount(), n);
+            m_pool.forSlices(store.edgeCount(), [&](int thread, int begin, int end) {
+                m_edgeForces.clear(thread);
+                attract(begin, end, m_edgeForces.fx(thread), m_edgeForces.fy(thread));
+            });
+            m_edgeForces.addTo(m_pool, m_fx.data(), m_fy.data());
+        }
+
+        for (int i = 0; i < n; ++i) {
+            ForcePolicy::gravity(c, x[i], y[i], m_mass[i], m_fx[i], m_fy[i]);
+        }
+
+        m_forces.move(store, m_fx, m_fy, m_mass, params);
+    }
+
+private:
+    // Nodes per block handed to a thread.
+    static constexpr int treeBlock = 256;
+    static constexpr int exactBlock = 32;
+
+    ForcePool& m_pool;
+    ForcePolicy m_forces;
+    BarnesHutTree m_tree;
+    PerThreadForces m_edgeForces;
+    std::vector<double> m_mass; // per node, 1 unless the policy weighs by degree
+    std::vector<double> m_fx, m_fy;
+};
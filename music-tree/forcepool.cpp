@@ -0,0 +1,57 @@
+#include "forcepool.h"
+#include <QSemaphore>
+#include <QThread>
+
+ForcePool::ForcePool(int threads) {
+    setThreadCount(threads);
+}
+
+ForcePool::~ForcePool() {
+    m_pool.waitForDone();
+}
+
+void ForcePool::setThreadCount(int threads) {
+    m_threads = threads > 0 ? threads : std::max(1, QThread::idealThreadCount());
+    m_pool.setMaxThreadCount(std::max(1, m_threads - 1));
+}
+
+void ForcePool::runOnAll(const std::function<void(int)>& job) {
+    QSemaphore done;
+    for (int thread = 1; thread < m_threads; ++thread) {
+        m_pool.start([&job, &done, thread] {
+            job(thread);
+            done.release();
+        });
+    }
+    job(0);
+    done.acquire(m_threads - 1);
+}
+
+void PerThreadForces::reset(int threads, int count) {
+    m_count = count;
+    m_fx.resize(threads);
+    m_fy.resize(threads);
+    for (int t = 0; t < threads; ++t) {
+        m_fx[t].resize(count);
+        m_fy[t].resize(count);
+    }
+}
+
+void PerThreadForces::clear(int thread) {
+    std::fill(m_fx[thread].begin(), m_fx[thread].end(), 0.0);
+    std::fill(m_fy[thread].begin(), m_fy[thread].end(), 0.0);
+}
+
+void PerThreadForces::addTo(ForcePool& pool, double* fx, double* fy) const {
+    constexpr int blockSize = 4096;
+    pool.forBlocks(m_count, blockSize, [&](int begin, int end) {
+        for (size_t t = 0; t < m_fx.size(); ++t) {
+            const double* bx = m_fx[t].data();
+            const double* by = m_fy[t].data();
+            for (int i = begin; i < end; ++i) {
+                fx[i] += bx[i];
+                fy[i] += by[i];
+            }
+        }
+    });
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+// Worker threads for the force computation, owned by the layout thread.
+// A private QThreadPool so layout work never queues behind (or blocks)
+// QtConcurrent jobs on the global pool.
+//
+// Two ways to split a phase:
+//  - forBlocks(): a dynamic schedule. Every thread takes the next node
+//    block from one shared atomic counter until the range is used up, so
+//    threads that finish early take more blocks. There are no per-thread
+//    queues and no stealing; one slow block still holds up the phase. Use it
+//    when each item writes only its own output (e.g. the repulsion on one
+//    node); the result does not depend on which thread ran which block.
+//  - forSlices() + PerThreadForces: one fixed, contiguous slice per thread,
+//    each accumulating into its own buffer, reduced in thread order. Use it
+//    when items scatter into shared outputs (e.g. an edge into both ends);
+//    the result only depends on the thread count.
+// The calling thread always takes part, so a pool of one runs inline.
+class ForcePool {
+public:
+    // threads <= 0 uses QThread::idealThreadCount().
+    explicit ForcePool(int threads = 0);
+    ~ForcePool();
+
+    void setThreadCount(int threads);
+    int threadCount() const { return m_threads; }
+
+    // Calls fn(begin, end) on blocks of [0, count), each block claimed by
+    // whichever thread bumps the counter next. Runs inline when the range
+    // fits in one block.
+    template <typename Fn>
+    void forBlocks(int count, int blockSize, const Fn& fn) {
+        if (count <= blockSize || m_threads == 1) {
+            if (count > 0) fn(0, count);
+            return;
+        }
+        std::atomic<int> next{0};
+        runOnAll([&](int) {
+            for (int begin = next.fetch_add(blockSize); begin < count; begin = next.fetch_add(blockSize)) {
+                fn(begin, std::min(count, begin + blockSize));
+            }
+        });
+    }
+
+    // Calls fn(thread, begin, end) once per thread with that thread's fixed
+    // slice of [0, count).
+    template <typename Fn>
+    void forSlices(int count, const Fn& fn) {
+        if (m_threads == 1) {
+            fn(0, 0, count);
+            return;
+        }
+        runOnAll([&](int thread) {
+            fn(thread, sliceBegin(count, thread), sliceBegin(count, thread + 1));
+        });
+    }
+
+private:
+    int sliceBegin(int count, int thread) const { return int(qint64(count) * thread / m_threads); }
+    // Runs job(0) here and job(1..threads-1) on the pool; returns when all are done.
+    void runOnAll(const std::function<void(int)>& job);
+
+    QThreadPool m_pool;
+    int m_threads = 1;
+};
+
+// One force buffer per pool thread for forSlices() phases.
+class PerThreadForces {
+public:
+    // Sizes the buffers; each thread then clears its own inside the phase,
+    // so zeroing is spread over the pool too.
+    void reset(int threads, int count);
+    void clear(int thread);
+
+    double* fx(int thread) { return m_fx[thread].data(); }
+    double* fy(int thread) { return m_fy[thread].data(); }
+
+    // Adds every buffer to (fx, fy), thread 0 first, in node blocks on the pool.
+    void addTo(ForcePool& pool, double* fx, double* fy) const;
+
+private:
+    int m_count = 0;
+    std::vector<std::vector<double>> m_fx, m_fy;
+};
@@ -0,0 +1,727 @@
+#include "graphscenenode.h"
+#include <QFontMetricsF>
+#include <QGuiApplication>
+#include <QImage>
+#include <QMatrix4x4>
+#include <QPainter>
+#include <QTextLayout>
+#include <QSGTextNode>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+QSGGeometryNode* makeGeometryNode(const QSGGeometry::AttributeSet& attributes, QSGMaterial* material,
+                                  QSGGeometry::DataPattern pattern = QSGGeometry::StreamPattern) {
+    auto* geometry = new QSGGeometry(attributes, 0);
+    geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+    geometry->setVertexDataPattern(pattern);
+
+    auto* node = new QSGGeometryNode;
+    node->setGeometry(geometry);
+    node->setMaterial(material);
+    node->setFlag(QSGNode::OwnsGeometry);
+    node->setFlag(QSGNode::OwnsMaterial);
+    return node;
+}
+
+// Conservative segment/rectangle test: the segment's bounding box overlaps.
+bool segmentMayCross(const QRectF& r, double ax, double ay, double bx, double by) {
+    return std::max(ax, bx) >= r.left() && std::min(ax, bx) <= r.right()
+        && std::max(ay, by) >= r.top() && std::min(ay, by) <= r.bottom();
+}
+
+// One antialiased circle, drawn once and stamped onto a quad per node.
+QImage circleImage(double radius, qreal dpr, const QColor& fill, const QColor& outline, double penWidth) {
+    const int size = int(std::ceil((radius * 2.0 + 2.0) * dpr));
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.scale(dpr, dpr);
+    painter.setBrush(fill);
+    painter.setPen(QPen(outline, penWidth));
+    painter.drawEllipse(QPointF(radius + 1.0, radius + 1.0), radius, radius);
+    return image;
+}
+
+// Each edge is a quad (two triangles) so it can carry its own width.
+void writeEdgeQuads(QSGGeometryNode* node, const std::vector<int>& edges,
+                    const std::vector<int>& edgeA, const std::vector<int>& edgeB, const std::vector<double>& edgeWeight,
+                    const std::vector<double>& xs, const std::vector<double>& ys,
+                    double pixel, bool detailed) {
+    QSGGeometry* geometry = node->geometry();
+    const int vertexCount = int(edges.size()) * 6;
+    if (geometry->vertexCount() != vertexCount) {
+        geometry->allocate(vertexCount);
+    }
+    QSGGeometry::Point2D* v = geometry->vertexDataAsPoint2D();
+
+    for (int e : edges) {
+        const int a = edgeA[e], b = edgeB[e];
+        const float ax = float(xs[a]), ay = float(ys[a]);
+        const float bx = float(xs[b]), by = float(ys[b]);
+
+        const double sharedReleasesCount = edgeWeight[e];
+        const double screenWidth = detailed ? std::min(8.0, 1.0 + sharedReleasesCount * 0.5) : 1.0;
+        const float halfWidth = float(screenWidth * pixel / 2.0);
+        const float len = std::hypot(bx - ax, by - ay);
+        const float nx = len > 0.0f ? -(by - ay) / len * halfWidth : 0.0f;
+        const float ny = len > 0.0f ? (bx - ax) / len * halfWidth : 0.0f;
+
+        v[0].set(ax + nx, ay + ny);
+        v[1].set(ax - nx, ay - ny);
+        v[2].set(bx + nx, by + ny);
+        v[3].set(bx + nx, by + ny);
+        v[4].set(ax - nx, ay - ny);
+        v[5].set(bx - nx, by - ny);
+        v += 6;
+    }
+    node->markDirty(QSGNode::DirtyGeometry);
+}
+
+void writeNodeQuads(QSGGeometryNode* node, const std::vector<int>& indices,
+                    const std::vector<double>& xs, const std::vector<double>& ys, float r) {
+    QSGGeometry* geometry = node->geometry();
+    const int vertexCount = int(indices.size()) * 6;
+    if (geometry->vertexCount() != vertexCount) {
+        geometry->allocate(vertexCount);
+    }
+    QSGGeometry::TexturedPoint2D* v = geometry->vertexDataAsTexturedPoint2D();
+    for (int i : indices) {
+        const float x = float(xs[i]), y = float(ys[i]);
+        v[0].set(x - r, y - r, 0.0f, 0.0f);
+        v[1].set(x + r, y - r, 1.0f, 0.0f);
+        v[2].set(x - r, y + r, 0.0f, 1.0f);
+        v[3].set(x + r, y - r, 1.0f, 0.0f);
+        v[4].set(x + r, y + r, 1.0f, 1.0f);
+        v[5].set(x - r, y + r, 0.0f, 1.0f);
+        v += 6;
+    }
+    node->markDirty(QSGNode::DirtyGeometry);
+}
+
+} // namespace
+
+GraphSceneNode::GraphSceneNode(QQuickWindow* window)
+    : m_window(window)
+{
+    const auto edgeNode = [](QSGGeometry::DataPattern pattern) {
+        auto* material = new QSGFlatColorMaterial;
+        material->setColor(Qt::gray);
+        return makeGeometryNode(QSGGeometry::defaultAttributes_Point2D(), material, pattern);
+    };
+    const auto nodeNode = [](QSGGeometry::DataPattern pattern) {
+        auto* material = new QSGTextureMaterial;
+        material->setFiltering(QSGTexture::Linear);
+        return makeGeometryNode(QSGGeometry::defaultAttributes_TexturedPoint2D(), material, pattern);
+    };
+    // The static layer is uploaded once per rebuild and then left alone.
+    m_staticEdgeNode = edgeNode(QSGGeometry::StaticPattern);
+    m_staticNodeNode = nodeNode(QSGGeometry::StaticPattern);
+    m_staticSelectedNode = nodeNode(QSGGeometry::StaticPattern);
+    m_edgeNode = edgeNode(QSGGeometry::StreamPattern);
+    m_nodeNode = nodeNode(QSGGeometry::StreamPattern);
+    m_selectedNodeNode = nodeNode(QSGGeometry::StreamPattern);
+
+    auto* bandFillMaterial = new QSGFlatColorMaterial;
+    bandFillMaterial->setColor(QColor(0, 120, 215, 40));
+    m_rubberBandFill = makeGeometryNode(QSGGeometry::defaultAttributes_Point2D(), bandFillMaterial);
+    m_rubberBandFill->geometry()->setDrawingMode(QSGGeometry::DrawTriangleStrip);
+
+    auto* bandOutlineMaterial = new QSGFlatColorMaterial;
+    bandOutlineMaterial->setColor(QColor(0, 120, 215));
+    m_rubberBandOutline = makeGeometryNode(QSGGeometry::defaultAttributes_Point2D(), bandOutlineMaterial);
+    m_rubberBandOutline->geometry()->setDrawingMode(QSGGeometry::DrawLineStrip);
+    m_rubberBandOutline->geometry()->setLineWidth(1.0f);
+
+    m_cameraNode = new QSGTransformNode;
+    m_labelRoot = new QSGNode;
+    m_staticLabelRoot = new QSGNode;
+    m_dynamicLabelRoot = new QSGNode;
+    m_labelRoot->appendChildNode(m_staticLabelRoot);
+    m_labelRoot->appendChildNode(m_dynamicLabelRoot);
+
+    // Painter's order: edges, then nodes on top, then labels, then the rubber
+    // band. Within each, moving elements are drawn over settled ones.
+    m_cameraNode->appendChildNode(m_staticEdgeNode);
+    m_cameraNode->appendChildNode(m_edgeNode);
+    m_cameraNode->appendChildNode(m_staticNodeNode);
+    m_cameraNode->appendChildNode(m_nodeNode);
+    m_cameraNode->appendChildNode(m_staticSelectedNode);
+    m_cameraNode->appendChildNode(m_selectedNodeNode);
+    appendChildNode(m_cameraNode);
+    appendChildNode(m_labelRoot);
+    appendChildNode(m_rubberBandFill);
+    appendChildNode(m_rubberBandOutline);
+}
+
+GraphSceneNode::~GraphSceneNode() {
+    clearLabels();
+}
+
+void GraphSceneNode::update(const LayoutFrame& frame, const SceneView& view) {
+    if (!frame.topology) return;
+
+    QMatrix4x4 m;
+    m.translate(float(view.camera.offset.x()), float(view.camera.offset.y()));
+    m.scale(float(view.camera.scale));
+    m_cameraNode->setMatrix(m);
+
+    // Pad by a node radius so nodes and labels sliding in from the edge are not clipped.
+    const double pad = view.nodeRadius * 2.0;
+    const QRectF visible = view.camera.visibleWorld(view.size).adjusted(-pad, -pad, pad, pad);
+    const bool detailed = view.detailed();
+
+    const bool topologyChanged = frame.topology != m_layerTopology;
+    if (topologyChanged) {
+        m_layerTopology = frame.topology;
+        m_staticValid = false;
+    }
+    syncEdges(frame, topologyChanged);
+    // Everything below draws the blended positions.
+    updatePositions(frame, view.blend, topologyChanged);
+    ensureNodeTextures(view.nodeRadius);
+    updateMotion(view, visible, detailed);
+    if (!m_staticValid) {
+        updateStaticLayer(view, visible, detailed);
+    }
+    updateDynamicLayer(view, visible, detailed);
+    updateLabels(frame, view, visible, detailed);
+    updateRubberBand(view.rubberBand);
+}
+
+void GraphSceneNode::ensureNodeTextures(double nodeRadius) {
+    if (m_nodeTexture && m_nodeTextureRadius == nodeRadius) return;
+
+    const qreal dpr = m_window->effectiveDevicePixelRatio();
+    m_nodeTexture.reset(m_window->createTextureFromImage(
+        circleImage(nodeRadius, dpr, Qt::white, Qt::black, 1.0)));
+    m_selectedNodeTexture.reset(m_window->createTextureFromImage(
+        circleImage(nodeRadius, dpr, QColor(205, 228, 250), QColor(0, 120, 215), 2.0)));
+    m_nodeTextureRadius = nodeRadius;
+
+    for (QSGGeometryNode* node : {m_staticNodeNode, m_nodeNode}) {
+        static_cast<QSGTextureMaterial*>(node->material())->setTexture(m_nodeTexture.get());
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+    for (QSGGeometryNode* node : {m_staticSelectedNode, m_selectedNodeNode}) {
+        static_cast<QSGTextureMaterial*>(node->material())->setTexture(m_selectedNodeTexture.get());
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+    m_staticValid = false;
+}
+
+// Brings the edges up to the frame: from the topology's after a topology
+// change, then the edge deltas not applied yet, oldest first.
+void GraphSceneNode::syncEdges(const LayoutFrame& frame, bool reset) {
+    if (reset) {
+        const LayoutTopology& topology = *frame.topology;
+        const int n = int(topology.ids.size());
+        const int edgeCount = int(topology.edgeA.size());
+        m_edgeA = topology.edgeA;
+        m_edgeB = topology.edgeB;
+        m_edgeWeight = topology.edgeWeight;
+        m_edgeVersion = 0;
+        m_incident.assign(n, {});
+        m_slotA.resize(edgeCount);
+        m_slotB.resize(edgeCount);
+        for (int e = 0; e < edgeCount; ++e) {
+            m_slotA[e] = int(m_incident[m_edgeA[e]].size());
+            m_incident[m_edgeA[e]].push_back(e);
+            m_slotB[e] = int(m_incident[m_edgeB[e]].size());
+            m_incident[m_edgeB[e]].push_back(e);
+        }
+        m_staticEdgeQuad.assign(edgeCount, -1);
+        m_extraEdges.clear();
+    }
+
+    std::vector<const LayoutEdgeDelta*> pending;
+    for (const LayoutEdgeDelta* delta = frame.edgeDelta.get(); delta && delta->version > m_edgeVersion;
+         delta = delta->previous.get()) {
+        pending.push_back(delta);
+    }
+    if (pending.empty()) return;
+
+    for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+        for (const LayoutEdgeChange& change : (*it)->changes) {
+            applyEdgeChange(change);
+        }
+    }
+    m_edgeVersion = pending.front()->version;
+    // Collaboration counts are the label priority.
+    m_staticLabelsValid = false;
+}
+
+// Like LayoutStore's edge updates, plus the static layer's quads.
+void GraphSceneNode::applyEdgeChange(const LayoutEdgeChange& change) {
+    const bool degreeKnown = m_labelDegree.size() == m_incident.size();
+    if (change.kind == LayoutEdgeChange::Added) {
+        const int e = int(m_edgeA.size());
+        m_edgeA.push_back(change.a);
+        m_edgeB.push_back(change.b);
+        m_edgeWeight.push_back(change.weight);
+        m_slotA.push_back(int(m_incident[change.a].size()));
+        m_incident[change.a].push_back(e);
+        m_slotB.push_back(int(m_incident[change.b].size()));
+        m_incident[change.b].push_back(e);
+        m_staticEdgeQuad.push_back(-1);
+        if (degreeKnown) {
+            ++m_labelDegree[change.a];
+            ++m_labelDegree[change.b];
+        }
+        // Between two nodes of the static layer neither endpoint draws it
+        // with the dynamic layer, so it is drawn there on its own.
+        if (m_staticValid && m_inStatic[change.a] && m_inStatic[change.b]) {
+            m_extraEdges.push_back(e);
+        }
+        return;
+    }
+
+    // Removed: the last edge moves into its place.
+    const int e = change.edge;
+    const int last = int(m_edgeA.size()) - 1;
+    if (degreeKnown) {
+        --m_labelDegree[m_edgeA[e]];
+        --m_labelDegree[m_edgeB[e]];
+    }
+    if (m_staticEdgeQuad[e] >= 0) {
+        // Collapsed to a point rather than rewriting the layer.
+        QSGGeometry::Point2D* v = m_staticEdgeNode->geometry()->vertexDataAsPoint2D() + m_staticEdgeQuad[e] * 6;
+        for (int k = 0; k < 6; ++k) v[k].set(0.0f, 0.0f);
+        m_staticEdgeNode->markDirty(QSGNode::DirtyGeometry);
+    }
+    m_extraEdges.erase(std::remove(m_extraEdges.begin(), m_extraEdges.end(), e), m_extraEdges.end());
+    std::replace(m_extraEdges.begin(), m_extraEdges.end(), last, e);
+
+    unlinkIncident(m_edgeA[e], m_slotA[e]);
+    unlinkIncident(m_edgeB[e], m_slotB[e]);
+    if (e != last) {
+        m_edgeA[e] = m_edgeA[last];
+        m_edgeB[e] = m_edgeB[last];
+        m_edgeWeight[e] = m_edgeWeight[last];
+        m_slotA[e] = m_slotA[last];
+        m_slotB[e] = m_slotB[last];
+        m_staticEdgeQuad[e] = m_staticEdgeQuad[last];
+        m_incident[m_edgeA[e]][m_slotA[e]] = e;
+        m_incident[m_edgeB[e]][m_slotB[e]] = e;
+    }
+    m_edgeA.pop_back();
+    m_edgeB.pop_back();
+    m_edgeWeight.pop_back();
+    m_slotA.pop_back();
+    m_slotB.pop_back();
+    m_staticEdgeQuad.pop_back();
+}
+
+// Swap-removes entry 'slot' of the node's incidence list.
+void GraphSceneNode::unlinkIncident(int node, int slot) {
+    std::vector<int>& incident = m_incident[node];
+    const int moved = incident.back();
+    incident[slot] = moved;
+    incident.pop_back();
+    if (slot < int(incident.size())) {
+        if (m_edgeA[moved] == node) m_slotA[moved] = slot;
+        else m_slotB[moved] = slot;
+    }
+}
+
+// Blends the nodes whose drawn position may have changed since the last
+// call: the moving ones, since the blend moved on, and those the layout
+// frame lists as changed. Everything after a topology change, a skipped
+// frame or a frame that changed every node.
+void GraphSceneNode::updatePositions(const LayoutFrame& frame, double t, bool reset) {
+    const int n = int(frame.x.size());
+    const bool hasFrom = frame.fromX.size() == size_t(n);
+    const bool blending = hasFrom && t < 1.0;
+    const auto place = [&](int i) {
+        if (blending) {
+            m_x[i] = frame.fromX[i] + (frame.x[i] - frame.fromX[i]) * t;
+            m_y[i] = frame.fromY[i] + (frame.y[i] - frame.fromY[i]) * t;
+        } else {
+            m_x[i] = frame.x[i];
+            m_y[i] = frame.y[i];
+        }
+        // A node moves while its last step is still being blended in.
+        m_moving[i] = hasFrom && (frame.fromX[i] != frame.x[i] || frame.fromY[i] != frame.y[i]);
+    };
+
+    const bool newFrame = frame.serial != m_frameSerial;
+    m_allTouched = reset || int(m_x.size()) != n
+                   || (newFrame && (frame.allChanged || frame.serial != m_frameSerial + 1));
+    m_frameSerial = frame.serial;
+    m_touched.clear();
+    if (m_allTouched) {
+        m_movingNodes.clear();
+        m_x.resize(n);
+        m_y.resize(n);
+        m_moving.resize(n);
+        m_touchedMark.assign(n, 0);
+        for (int i = 0; i < n; ++i) {
+            place(i);
+            if (m_moving[i]) m_movingNodes.push_back(i);
+        }
+        return;
+    }
+
+    const auto touch = [this](int i) {
+        if (m_touchedMark[i]) return;
+        m_touchedMark[i] = 1;
+        m_touched.push_back(i);
+    };
+    for (int i : m_movingNodes) touch(i);
+    if (newFrame) {
+        for (int i : frame.changed) touch(i);
+    }
+    m_movingNodes.clear();
+    for (int i : m_touched) {
+        m_touchedMark[i] = 0;
+        place(i);
+        if (m_moving[i]) m_movingNodes.push_back(i);
+    }
+}
+
+void GraphSceneNode::updateMotion(const SceneView& view, const QRectF& visible, bool detailed) {
+    const int n = int(m_x.size());
+    const double tolerance = staticTolerance / view.camera.scale;
+    const std::vector<char>* selection = view.selection;
+    const bool hasSelection = selection && int(selection->size()) == n;
+
+    // The static layer was drawn for one zoom, node size, selection and
+    // region; any change there redraws it.
+    if (m_staticValid) {
+        m_staticValid = view.camera.scale == m_staticScale && detailed == m_staticDetailed
+                        && view.nodeRadius == m_staticNodeRadius && m_staticRegion.contains(visible)
+                        && int(m_inStatic.size()) == n
+                        && (hasSelection ? *selection == m_staticSelection : m_staticSelection.empty());
+    }
+
+    // A node in the static layer that has drifted off its cached spot
+    // invalidates it; only nodes blended again this frame can have drifted.
+    const auto drifted = [&](int i) {
+        return m_inStatic[i]
+            && (std::abs(m_x[i] - m_staticX[i]) > tolerance || std::abs(m_y[i] - m_staticY[i]) > tolerance);
+    };
+    if (m_staticValid && m_allTouched) {
+        for (int i = 0; i < n && m_staticValid; ++i) {
+            if (drifted(i)) m_staticValid = false;
+        }
+    } else if (m_staticValid) {
+        m_staticValid = std::none_of(m_touched.begin(), m_touched.end(), drifted);
+    }
+
+    // Most of the dynamic layer came to rest: fold it back into the cache.
+    const int moving = int(m_movingNodes.size());
+    if (m_staticValid && int(m_dynamicNodes.size()) > std::max(minDynamicRebuild, 2 * moving)) {
+        m_staticValid = false;
+    }
+}
+
+void GraphSceneNode::updateStaticLayer(const SceneView& view, const QRectF& visible, bool detailed) {
+    const int n = int(m_x.size());
+    const std::vector<char>* selection = view.selection;
+    const bool hasSelection = selection && int(selection->size()) == n;
+
+    // Cached with a margin of half a viewport on every side, so panning
+    // does not redraw it right away.
+    m_staticRegion = visible.adjusted(-visible.width() / 2.0, -visible.height() / 2.0,
+                                      visible.width() / 2.0, visible.height() / 2.0);
+    m_staticScale = view.camera.scale;
+    m_staticDetailed = detailed;
+    m_staticNodeRadius = view.nodeRadius;
+    if (hasSelection) {
+        m_staticSelection = *selection;
+    } else {
+        m_staticSelection.clear();
+    }
+    m_staticX = m_x;
+    m_staticY = m_y;
+    m_inStatic.resize(n);
+    m_dynamicNodes.clear();
+    for (int i = 0; i < n; ++i) {
+        m_inStatic[i] = !m_moving[i];
+        if (m_moving[i]) m_dynamicNodes.push_back(i);
+    }
+
+    m_layerEdges.clear();
+    m_staticEdgeQuad.assign(m_edgeA.size(), -1);
+    m_extraEdges.clear();
+    for (int e = 0; e < int(m_edgeA.size()); ++e) {
+        const int a = m_edgeA[e], b = m_edgeB[e];
+        if (m_inStatic[a] && m_inStatic[b] && segmentMayCross(m_staticRegion, m_x[a], m_y[a], m_x[b], m_y[b])) {
+            m_staticEdgeQuad[e] = int(m_layerEdges.size());
+            m_layerEdges.push_back(e);
+        }
+    }
+    m_layerNodes.clear();
+    m_layerSelected.clear();
+    for (int i = 0; i < n; ++i) {
+        if (m_inStatic[i] && m_staticRegion.contains(m_x[i], m_y[i])) {
+            m_layerNodes.push_back(i);
+            if (hasSelection && (*selection)[i]) m_layerSelected.push_back(i);
+        }
+    }
+
+    const float r = float(view.drawnNodeRadius() + (detailed ? 1.0 : 0.0));
+    writeEdgeQuads(m_staticEdgeNode, m_layerEdges, m_edgeA, m_edgeB, m_edgeWeight, m_x, m_y,
+                   1.0 / view.camera.scale, detailed);
+    writeNodeQuads(m_staticNodeNode, m_layerNodes, m_x, m_y, r);
+    writeNodeQuads(m_staticSelectedNode, m_layerSelected, m_x, m_y, r);
+    m_staticNodes.assign(m_layerNodes.begin(), m_layerNodes.end());
+    m_staticValid = true;
+    m_staticLabelsValid = false;
+}
+
+void GraphSceneNode::updateDynamicLayer(const SceneView& view, const QRectF& visible, bool detailed) {
+    const int nodeCount = int(m_x.size());
+    const std::vector<char>* selection = view.selection;
+    const bool hasSelection = selection && int(selection->size()) == nodeCount;
+
+    // Nodes outside the static layer and their edges; an edge between two
+    // such nodes is taken from its lower endpoint. The visible ones are
+    // also the moving label candidates.
+    m_layerEdges.clear();
+    m_layerNodes.clear();
+    m_layerSelected.clear();
+    m_visibleNodes.clear();
+    for (int i : m_dynamicNodes) {
+        if (visible.contains(m_x[i], m_y[i])) {
+            m_layerNodes.push_back(i);
+            m_visibleNodes.push_back(i);
+            if (hasSelection && (*selection)[i]) m_layerSelected.push_back(i);
+        }
+        for (int e : m_incident[i]) {
+            const int a = m_edgeA[e], b = m_edgeB[e];
+            const int other = a == i ? b : a;
+            if (!m_inStatic[other] && other < i) continue;
+            if (segmentMayCross(visible, m_x[a], m_y[a], m_x[b], m_y[b])) {
+                m_layerEdges.push_back(e);
+            }
+        }
+    }
+    for (int e : m_extraEdges) {
+        const int a = m_edgeA[e], b = m_edgeB[e];
+        if (segmentMayCross(visible, m_x[a], m_y[a], m_x[b], m_y[b])) {
+            m_layerEdges.push_back(e);
+        }
+    }
+
+    // Zoomed out, nodes become fixed-size dots instead of scaled circles.
+    // The texture has a 1px border around the outline. Selected nodes are
+    // drawn a second time on top with the highlight texture.
+    const float r = float(view.drawnNodeRadius() + (detailed ? 1.0 : 0.0));
+    writeEdgeQuads(m_edgeNode, m_layerEdges, m_edgeA, m_edgeB, m_edgeWeight, m_x, m_y,
+                   1.0 / view.camera.scale, detailed);
+    writeNodeQuads(m_nodeNode, m_layerNodes, m_x, m_y, r);
+    writeNodeQuads(m_selectedNodeNode, m_layerSelected, m_x, m_y, r);
+}
+
+void GraphSceneNode::updateRubberBand(const QRectF& rect) {
+    QSGGeometry* fill = m_rubberBandFill->geometry();
+    QSGGeometry* outline = m_rubberBandOutline->geometry();
+    if (rect.isNull()) {
+        if (fill->vertexCount() != 0) {
+            fill->allocate(0);
+            outline->allocate(0);
+            m_rubberBandFill->markDirty(QSGNode::DirtyGeometry);
+            m_rubberBandOutline->markDirty(QSGNode::DirtyGeometry);
+        }
+        return;
+    }
+
+    const float l = float(rect.left()), t = float(rect.top());
+    const float r = float(rect.right()), b = float(rect.bottom());
+    if (fill->vertexCount() != 4) fill->allocate(4);
+    QSGGeometry::Point2D* f = fill->vertexDataAsPoint2D();
+    f[0].set(l, t);
+    f[1].set(r, t);
+    f[2].set(l, b);
+    f[3].set(r, b);
+
+    if (outline->vertexCount() != 5) outline->allocate(5);
+    QSGGeometry::Point2D* o = outline->vertexDataAsPoint2D();
+    o[0].set(l, t);
+    o[1].set(r, t);
+    o[2].set(r, b);
+    o[3].set(l, b);
+    o[4].set(l, t);
+
+    m_rubberBandFill->markDirty(QSGNode::DirtyGeometry);
+    m_rubberBandOutline->markDirty(QSGNode::DirtyGeometry);
+}
+
+void GraphSceneNode::clearLabels() {
+    m_staticLabelRoot->removeAllChildNodes();
+    m_dynamicLabelRoot->removeAllChildNodes();
+    m_staticLabelsValid = false;
+    for (const Label& label : std::as_const(m_labelCache)) {
+        delete label.node; // deletes the text node below the transform too
+    }
+    m_labelCache.clear();
+    m_labels.clear();
+}
+
+QSGTransformNode* GraphSceneNode::createLabel(const QString& name, QSizeF& size) const {
+    QTextLayout layout(name, QGuiApplication::font());
+    layout.beginLayout();
+    QTextLine line = layout.createLine();
+    line.setPosition(QPointF(0, 0));
+    layout.endLayout();
+    size = QSizeF(line.naturalTextWidth(), line.height());
+
+    QSGTextNode* text = m_window->createTextNode();
+    text->setColor(Qt::black);
+    text->addTextLayout(QPointF(0, 0), &layout);
+
+    // Attached and detached as the label enters/leaves the viewport,
+    // so ownership stays with the cache rather than the parent.
+    auto* transform = new QSGTransformNode;
+    transform->setFlag(QSGNode::OwnedByParent, false);
+    transform->appendChildNode(text);
+    return transform;
+}
+
+void GraphSceneNode::syncLabels(const LayoutTopology& topology) {
+    m_staticLabelRoot->removeAllChildNodes();
+    m_dynamicLabelRoot->removeAllChildNodes();
+    m_staticLabelsValid = false;
+    m_labelAscent = QFontMetricsF(QGuiApplication::font()).ascent();
+    const quint64 generation = ++m_labelGeneration;
+
+    for (qsizetype i = 0; i < topology.ids.size(); ++i) {
+        Label& label = m_labelCache[topology.ids[i]];
+        if (!label.node || label.name != topology.names[i]) {
+            delete label.node;
+            label.name = topology.names[i];
+            label.node = createLabel(label.name, label.size);
+        }
+        label.generation = generation;
+    }
+
+    // Drop artists that left the graph.
+    for (auto it = m_labelCache.begin(); it != m_labelCache.end();) {
+        if (it->generation != generation) {
+            delete it->node;
+            it = m_labelCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Pointers into the hash stay valid until it is modified again, which
+    // only happens here.
+    m_labels.resize(topology.ids.size());
+    for (qsizetype i = 0; i < topology.ids.size(); ++i) {
+        m_labels[i] = &m_labelCache.find(topology.ids[i]).value();
+    }
+
+    // From the current edges (see syncEdges()), kept up to date as edge
+    // deltas arrive.
+    m_labelDegree.assign(topology.ids.size(), 0);
+    for (size_t e = 0; e < m_edgeA.size(); ++e) {
+        ++m_labelDegree[m_edgeA[e]];
+        ++m_labelDegree[m_edgeB[e]];
+    }
+}
+
+// Moving labels have to stay clear of the static ones too; static ones
+// are placed first, against each other only.
+bool GraphSceneNode::placeLabel(const QRectF& rect, const QSizeF& viewSize, bool moving) {
+    if (!rect.intersects(QRectF(QPointF(0, 0), viewSize))) return false;
+
+    const auto cell = [](double v, int cells) {
+        return std::clamp(int(std::floor(v / labelCellSize)), 0, cells - 1);
+    };
+    const int c0 = cell(rect.left(), m_labelCols), c1 = cell(rect.right(), m_labelCols);
+    const int r0 = cell(rect.top(), m_labelRows), r1 = cell(rect.bottom(), m_labelRows);
+
+    const auto collides = [&](const std::vector<std::vector<QRectF>>& cells) {
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                for (const QRectF& placed : cells[size_t(r) * m_labelCols + c]) {
+                    if (placed.intersects(rect)) return true;
+                }
+            }
+        }
+        return false;
+    };
+    if (collides(m_staticLabelCells) || (moving && collides(m_labelCells))) return false;
+
+    std::vector<std::vector<QRectF>>& cells = moving ? m_labelCells : m_staticLabelCells;
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            cells[size_t(r) * m_labelCols + c].push_back(rect);
+        }
+    }
+    return true;
+}
+
+// Places the labels of m_labelCandidates, best connected artists first.
+void GraphSceneNode::placeLabels(const SceneView& view, bool moving) {
+    std::sort(m_labelCandidates.begin(), m_labelCandidates.end(), [this](int a, int b) {
+        return m_labelDegree[a] != m_labelDegree[b] ? m_labelDegree[a] > m_labelDegree[b] : a < b;
+    });
+
+    QSGNode* root = moving ? m_dynamicLabelRoot : m_staticLabelRoot;
+    const double r = view.nodeRadius * view.camera.scale;
+    for (int i : m_labelCandidates) {
+        const Label& label = *m_labels[i];
+        // Same anchor as the old QPainter::drawText baseline position, in screen space.
+        const QPointF anchor = view.camera.toScreen(QPointF(m_x[i], m_y[i]));
+        const QPointF topLeft(anchor.x() - r / 2.0, anchor.y() - r - 5.0 - m_labelAscent);
+        if (!placeLabel(QRectF(topLeft, label.size), view.size, moving)) continue;
+
+        QMatrix4x4 m;
+        m.translate(float(topLeft.x()), float(topLeft.y()));
+        label.node->setMatrix(m);
+        root->appendChildNode(label.node);
+    }
+}
+
+void GraphSceneNode::updateLabels(const LayoutFrame& frame, const SceneView& view, const QRectF& visible,
+                                  bool detailed) {
+    if (frame.topology != m_labelTopology) {
+        syncLabels(*frame.topology);
+        m_labelTopology = frame.topology;
+    }
+
+    m_dynamicLabelRoot->removeAllChildNodes();
+    if (!detailed) {
+        m_staticLabelRoot->removeAllChildNodes();
+        m_staticLabelsValid = false;
+        return;
+    }
+
+    const auto clearCells = [this](std::vector<std::vector<QRectF>>& cells) {
+        cells.resize(size_t(m_labelCols) * m_labelRows);
+        for (std::vector<QRectF>& cell : cells) {
+            cell.clear();
+        }
+    };
+
+    // The static layer's labels only move with the camera, so they are kept
+    // until it or the static layer changes.
+    if (!m_staticLabelsValid || view.camera.scale != m_labelCamera.scale || view.camera.offset != m_labelCamera.offset
+        || view.size != m_labelViewSize || view.nodeRadius != m_labelNodeRadius) {
+        m_labelCamera = view.camera;
+        m_labelViewSize = view.size;
+        m_labelNodeRadius = view.nodeRadius;
+        m_labelCols = std::max(1, int(std::ceil(view.size.width() / labelCellSize)));
+        m_labelRows = std::max(1, int(std::ceil(view.size.height() / labelCellSize)));
+        clearCells(m_staticLabelCells);
+
+        m_labelCandidates.clear();
+        for (int i : m_staticNodes) {
+            if (visible.contains(m_x[i], m_y[i])) m_labelCandidates.push_back(i);
+        }
+        m_staticLabelRoot->removeAllChildNodes();
+        placeLabels(view, false);
+        m_staticLabelsValid = true;
+    }
+
+    // Moving nodes' labels take the space that is left.
+    // m_visibleNodes was filled by updateDynamicLayer() for this frame.
+    clearCells(m_labelCells);
+    m_labelCandidates.assign(m_visibleNodes.begin(), m_visibleNodes.end());
+    placeLabels(view, true);
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include <QSGNode>
+#include <QSGGeometryNode>
+#include <QSGTransformNode>
+#include <QSGFlatColorMaterial>
+#include <QSGTextureMaterial>
+#include <QSGTexture>
+#include <QQuickWindow>
+#include <QHash>
+#include <QVector>
+#include <memory>
+#include <vector>
+#include "camera.h"
+#include "layoutworker.h"
+
+// What the renderer needs from the item besides the layout frame.
+struct SceneView {
+    Camera camera;
+    QSizeF size;              // item size in pixels
+    double nodeRadius = 20.0; // world units
+    const std::vector<char>* selection = nullptr; // per frame node, non-zero when selected
+    QRectF rubberBand;        // screen space; null when no area selection is in progress
+    double blend = 1.0;       // LayoutFrame::blendAt() for this frame's render time
+
+    // Below this zoom the graph is drawn simplified.
+    static constexpr double detailZoom = 0.4;
+
+    bool detailed() const { return camera.scale >= detailZoom; }
+    // Radius a node is actually drawn with, in world units.
+    double drawnNodeRadius() const { return detailed() ? nodeRadius : 3.0 / camera.scale; }
+};
+
+// Scene graph for GraphViewItem. Edges live in one geometry node and nodes
+// in another per layer (see below), so a frame rewrites a few vertex
+// buffers instead of issuing a draw call per edge/ellipse. Labels are
+// pre-shaped text nodes that are rebuilt when the topology changes and
+// otherwise only moved.
+//
+// Edges and nodes are written in world coordinates below a transform node
+// holding the camera; only what intersects the viewport is emitted. Below
+// SceneView::detailZoom the graph is drawn simplified: hairline edges, nodes
+// as small dots and no labels. Selected nodes go into separate geometry
+// nodes with their own texture, and an area selection in progress is drawn
+// on top.
+//
+// The static layer holds the nodes that were at rest when it was built and
+// the edges among them, for the viewport plus a margin. It is uploaded once
+// and left alone until zoom, node size, selection or topology change, the
+// viewport leaves the margin, or one of its nodes drifts by more than
+// staticTolerance. The dynamic layer, rewritten every frame, holds only the
+// moving nodes and their edges. Dragging a node in a settled graph then
+// costs about the edges of the nodes it sets in motion, and panning within
+// the margin only the camera transform.
+//
+// Per frame, only the nodes that are moving or that the layout frame lists
+// as changed are blended and checked for drift, and the labels of the
+// static layer are only placed again when it or the camera changes; see
+// LayoutFrame::changed.
+//
+// Edges added or removed without a node change arrive as a
+// LayoutEdgeDelta and are patched in: the incidence lists, and in the
+// static layer the removed edge's quad (collapsed) and an added edge
+// between static nodes (drawn with the dynamic layer until the next
+// rebuild).
+class GraphSceneNode : public QSGNode {
+public:
+    explicit GraphSceneNode(QQuickWindow* window);
+    ~GraphSceneNode() override;
+
+    void update(const LayoutFrame& frame, const SceneView& view);
+
+private:
+    void syncEdges(const LayoutFrame& frame, bool reset);
+    void applyEdgeChange(const LayoutEdgeChange& change);
+    void unlinkIncident(int node, int slot);
+    void updatePositions(const LayoutFrame& frame, double t, bool reset);
+    void updateMotion(const SceneView& view, const QRectF& visible, bool detailed);
+    void updateStaticLayer(const SceneView& view, const QRectF& visible, bool detailed);
+    void updateDynamicLayer(const SceneView& view, const QRectF& visible, bool detailed);
+    void updateLabels(const LayoutFrame& frame, const SceneView& view, const QRectF& visible, bool detailed);
+    void syncLabels(const LayoutTopology& topology);
+    QSGTransformNode* createLabel(const QString& name, QSizeF& size) const;
+    void placeLabels(const SceneView& view, bool moving);
+    bool placeLabel(const QRectF& rect, const QSizeF& viewSize, bool moving);
+    void clearLabels();
+    void ensureNodeTextures(double nodeRadius);
+    void updateRubberBand(const QRectF& rect);
+
+    QQuickWindow* m_window;
+
+    QSGTransformNode* m_cameraNode;
+
+    // Geometry nodes own their geometry and material. Selected nodes are
+    // drawn with a highlight texture.
+    QSGGeometryNode* m_staticEdgeNode;
+    QSGGeometryNode* m_staticNodeNode;
+    QSGGeometryNode* m_staticSelectedNode;
+    QSGGeometryNode* m_edgeNode;
+    QSGGeometryNode* m_nodeNode;
+    QSGGeometryNode* m_selectedNodeNode;
+    std::unique_ptr<QSGTexture> m_nodeTexture;
+    std::unique_ptr<QSGTexture> m_selectedNodeTexture;
+    double m_nodeTextureRadius = 0.0;
+
+    // Screen-space rubber band of an area selection.
+    QSGGeometryNode* m_rubberBandFill;
+    QSGGeometryNode* m_rubberBandOutline;
+
+    // Labels stay in screen space so text keeps its size while zooming.
+    // Each artist's text is shaped once and cached by artist key, so topology
+    // changes only shape the names of new (or renamed) artists. Only labels
+    // that are visible and do not collide with a higher priority label are
+    // attached, those of static layer nodes to m_staticLabelRoot and those
+    // of moving nodes, placed in the gaps every frame, to
+    // m_dynamicLabelRoot; m_labelCache owns them all.
+    struct Label {
+        QString name;
+        QSGTransformNode* node = nullptr;
+        QSizeF size;               // text extent in pixels
+        quint64 generation = 0;    // last topology sync that saw the artist
+    };
+    QSGNode* m_labelRoot;
+    QSGNode* m_staticLabelRoot;
+    QSGNode* m_dynamicLabelRoot;
+    QHash<ArtistKey, Label> m_labelCache;
+    QVector<const Label*> m_labels;     // indexed like the topology's nodes
+    std::vector<int> m_labelDegree;     // collaborations per node, the label priority
+    std::shared_ptr<const LayoutTopology> m_labelTopology;
+    quint64 m_labelGeneration = 0;
+    double m_labelAscent = 0.0;
+
+    // Screen-space collision grids of the placed labels: the static layer's,
+    // kept while it and the camera stay the same, and this frame's moving ones.
+    static constexpr double labelCellSize = 64.0;
+    int m_labelCols = 0, m_labelRows = 0;
+    std::vector<std::vector<QRectF>> m_staticLabelCells;
+    std::vector<std::vector<QRectF>> m_labelCells;
+    std::vector<int> m_labelCandidates;
+    bool m_staticLabelsValid = false;
+    Camera m_labelCamera;             // what the static labels were placed for
+    QSizeF m_labelViewSize;
+    double m_labelNodeRadius = 0.0;
+
+    // Positions drawn this frame, blended between the layout frame's last
+    // two steps. Only the nodes in m_touched were blended again this frame,
+    // or all of them if m_allTouched.
+    std::vector<double> m_x, m_y;
+    quint64 m_frameSerial = 0;        // LayoutFrame::serial last drawn
+    std::vector<char> m_moving;       // per node: its last step is still being blended in
+    std::vector<int> m_movingNodes;
+    std::vector<int> m_touched;
+    std::vector<char> m_touchedMark;  // per node, scratch for m_touched
+    bool m_allTouched = true;
+
+    // Static layer, see the class comment. In screen pixels, how far a
+    // cached node may be off its drawn position; below a pixel the stale
+    // spot is not visible.
+    static constexpr double staticTolerance = 0.5;
+    // The dynamic layer is folded back into the static one once it has more
+    // than this many nodes and fewer than half of them still move.
+    static constexpr int minDynamicRebuild = 256;
+    bool m_staticValid = false;
+    QRectF m_staticRegion;            // world units
+    double m_staticScale = 0.0;
+    bool m_staticDetailed = false;
+    double m_staticNodeRadius = 0.0;
+    std::vector<char> m_staticSelection;
+    std::vector<double> m_staticX, m_staticY; // positions the layer was drawn with
+    std::vector<char> m_inStatic;     // per node
+    std::vector<int> m_staticNodes;   // in the static layer's region
+    std::vector<int> m_dynamicNodes;  // not in the static layer
+    std::shared_ptr<const LayoutTopology> m_layerTopology;
+    std::vector<int> m_staticEdgeQuad; // per edge, its quad in the static edge geometry or -1
+    std::vector<int> m_extraEdges;     // added among static nodes since the static layer was built
+
+    // The frame's edges: the topology's with its edge deltas applied up to
+    // m_edgeVersion. Per node the edges touching it, and per edge where it
+    // sits in its endpoints' lists, as in LayoutStore.
+    std::vector<int> m_edgeA, m_edgeB;
+    std::vector<double> m_edgeWeight;
+    quint64 m_edgeVersion = 0;
+    std::vector<std::vector<int>> m_incident;
+    std::vector<int> m_slotA, m_slotB;
+
+    // Per-frame culling results, kept to reuse their capacity.
+    std::vector<int> m_layerEdges;
+    std::vector<int> m_layerNodes;
+    std::vector<int> m_layerSelected;
+    std::vector<int> m_visibleNodes;  // dynamic ones, the moving label candidates
+};
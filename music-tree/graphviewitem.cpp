@@ -1,12 +1,12 @@
 #include "graphviewitem.h"
-#include <QPainter>
+#include <QCoreApplication>
+#include <QQuickWindow>
+#include <cmath>
+#include <limits>
 
 GraphViewItem::GraphViewItem(QQuickItem *parent)
-    : QQuickPaintedItem(parent)
+    : QQuickItem(parent)
 {
-    setRenderTarget(QQuickPaintedItem::FramebufferObject); // better perf
-    setAntialiasing(true);
-
     // setAcceptedMouseButtons(Qt::LeftButton | Qt::RightButton);
     setAcceptedMouseButtons(Qt::AllButtons); // allow clicks
     setAcceptHoverEvents(true);   // For hover without buttons
@@ -17,138 +17,241 @@ GraphViewItem::GraphViewItem(QQuickItem *parent)
     setKeepMouseGrab(true);
 
 
-    connect(&timer, &QTimer::timeout, this, &GraphViewItem::updateLayout);
-    timer.start(30); // ~33 FPS
+    m_layoutWorker = new LayoutWorker;
+    m_layoutWorker->moveToThread(&m_layoutThread);
+    connect(&m_layoutThread, &QThread::started, m_layoutWorker, &LayoutWorker::start);
+    connect(&m_layoutThread, &QThread::finished, m_layoutWorker, &QObject::deleteLater);
+    connect(m_layoutWorker, &LayoutWorker::frameReady, this, &GraphViewItem::onFrameReady);
+
+    pushLayoutParams();
+    m_layoutThread.setObjectName("GraphLayoutThread");
+    m_layoutThread.start();
 }
 
-void GraphViewItem::addArtistNode(const Artist& sessionArtist) {
+GraphViewItem::~GraphViewItem() {
+    m_layoutThread.quit();
+    m_layoutThread.wait();
+}
 
-    if (nodeData.contains(sessionArtist.id)) return;
+void GraphViewItem::addArtistNode(const Artist& sessionArtist, ArtistKey key) {
+    const auto saved = m_savedPositions.constFind(sessionArtist.id);
+    if (saved != m_savedPositions.cend()) {
+        m_layoutWorker->post(AddNodeCommand{key, sessionArtist.name, *saved, true});
+        return;
+    }
 
-    ArtistNode node;
-    node.name = sessionArtist.name;
-    node.pos = QPointF(QRandomGenerator::global()->bounded(width()),
-                       QRandomGenerator::global()->bounded(height()));
-    node.velocity = QPointF(0, 0);
+    // Only a hint: the simulation starts the node next to its collaborators
+    // once the edges arrive, and uses this spot (or free space near it)
+    // only if there are none.
+    const QRectF view = m_camera.visibleWorld(size());
+    const QPointF pos(view.left() + QRandomGenerator::global()->bounded(std::max(1.0, view.width())),
+                      view.top() + QRandomGenerator::global()->bounded(std::max(1.0, view.height())));
+    m_layoutWorker->post(AddNodeCommand{key, sessionArtist.name, pos});
+}
 
-    nodeData.insert(sessionArtist.id, node);
+void GraphViewItem::removeArtistNode(ArtistKey key) {
+    m_layoutWorker->post(RemoveNodeCommand{key});
 }
 
-void GraphViewItem::removeArtistNode(const Artist& sessionArtist) {
-    for (auto it = nodeData.begin(), end = nodeData.end(); it!=end; ++it) {
-        if (it.key() == sessionArtist.id) {
-            it = nodeData.erase(it);
-            break;
-        }
-    }
+void GraphViewItem::updateEdges(const CollabDelta& delta) {
+    // Collaborations touching nodes the simulation does not know are skipped there.
+    m_layoutWorker->post(UpdateEdgesCommand{delta, m_artistService->sessionSnapshot()});
+}
+
+void GraphViewItem::relayout() {
+    m_layoutWorker->post(RelayoutCommand{});
 }
 
-void GraphViewItem::finalizeGraphLayout() {
-    const QVector<Artist> artists = m_artistService->sessionArtists();
+void GraphViewItem::saveLayoutPositions() {
+    if (!m_artistService) return;
+    const LayoutFrame& frame = m_layoutWorker->frame();
+    if (!frame.topology) return;
+
+    // Only what moved noticeably since the last save is written.
+    constexpr double minMove = 0.5;
+    const IdTable& artistIds = m_artistService->sessionManager()->artistIds();
+    QHash<QString, QPointF> changed;
+    const QVector<ArtistKey>& ids = frame.topology->ids;
+    for (qsizetype i = 0; i < ids.size(); ++i) {
+        const QPointF pos(frame.x[i], frame.y[i]);
+        const QString& id = artistIds.toString(ids[i]);
+        auto saved = m_savedPositions.find(id);
+        if (saved != m_savedPositions.end() && QLineF(*saved, pos).length() < minMove) continue;
+        m_savedPositions.insert(id, pos);
+        changed.insert(id, pos);
+    }
+    if (changed.isEmpty()) return;
 
-    for (auto it = nodeData.begin(); it != nodeData.end(); ) {
-        auto artistStillInSession = std::find_if(artists.begin(), artists.end(),
-                                                 [&it](const Artist& a){ return a.id == it.key(); });
+    m_artistService->saveLayoutPositions(changed);
+}
 
-        if (artistStillInSession == artists.end()) {
-            it = nodeData.erase(it); // erase returns next iterator
-        } else {
-            ++it;
-        }
+void GraphViewItem::pushLayoutParams() {
+    switch (m_layoutAlgorithm) {
+    case LayoutAlgorithm::Springs:             m_layoutParams.model = LayoutModel::Springs; break;
+    case LayoutAlgorithm::FruchtermanReingold: m_layoutParams.model = LayoutModel::FruchtermanReingold; break;
+    case LayoutAlgorithm::ForceAtlas2:         m_layoutParams.model = LayoutModel::ForceAtlas2; break;
+    case LayoutAlgorithm::StressMajorization:  m_layoutParams.model = LayoutModel::StressMajorization; break;
     }
+    switch (m_repulsionMode) {
+    case RepulsionMode::Exact:     m_layoutParams.barnesHutThreshold = std::numeric_limits<int>::max(); break;
+    case RepulsionMode::BarnesHut: m_layoutParams.barnesHutThreshold = 0; break;
+    case RepulsionMode::Auto:      m_layoutParams.barnesHutThreshold = barnesHutThreshold; break;
+    }
+    m_layoutWorker->post(SetParamsCommand{m_layoutParams});
 }
 
+void GraphViewItem::setLayoutAlgorithm(LayoutAlgorithm algorithm) {
+    if (m_layoutAlgorithm == algorithm) return;
+    m_layoutAlgorithm = algorithm;
+    pushLayoutParams();
+    emit layoutAlgorithmChanged();
+}
 
-void GraphViewItem::updateLayout() {
-    // Repulsion
-    const QVector<Artist> artists = m_artistService->sessionArtists();
-    for (auto itA = artists.begin(); itA != artists.end(); ++itA) {
-        for (auto itB = itA; itB != artists.end(); ++itB) {
+void GraphViewItem::setRepulsionMode(RepulsionMode mode) {
+    if (m_repulsionMode == mode) return;
+    m_repulsionMode = mode;
+    pushLayoutParams();
+    emit repulsionModeChanged();
+}
 
-            QPointF delta = nodeData[itA->id].pos - nodeData[itB->id].pos;
-                //nodes[i].pos - nodes[j].pos;
-            double dist = std::max(1.0, std::hypot(delta.x(), delta.y()));
-            QPointF dir = delta / dist;
-            double force = repulsion / (dist * dist);
-            nodeData[itA->id].velocity += dir * force;
-            nodeData[itB->id].velocity -= dir * force;
-        }
-    }
+void GraphViewItem::setTheta(double theta) {
+    theta = std::max(0.0, theta);
+    if (qFuzzyCompare(m_layoutParams.theta, theta)) return;
+    m_layoutParams.theta = theta;
+    pushLayoutParams();
+    emit thetaChanged();
+}
 
-    // Springs
-    const SessionCollaborations collabs = m_artistService->collabs();
-    for (const auto &e : std::as_const(collabs)) {
-        QString artistId1 = e.first.a, artistId2 = e.first.b;
+void GraphViewItem::setActiveHops(int hops) {
+    hops = std::max(0, hops);
+    if (m_layoutParams.activeHops == hops) return;
+    m_layoutParams.activeHops = hops;
+    pushLayoutParams();
+    emit activeHopsChanged();
+}
 
-        QPointF delta = nodeData[artistId1].pos - nodeData[artistId2].pos;
-        double dist = std::max(1e-6, std::hypot(delta.x(), delta.y()));
-        QPointF dir = delta / dist;
-        double force = springStrength * (dist - springLength);
-        nodeData[artistId1].velocity -= dir * force;
-        nodeData[artistId2].velocity += dir * force;
+void GraphViewItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) {
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        if (!m_cameraPlaced && !newGeometry.isEmpty()) {
+            m_camera.offset = QPointF(newGeometry.width() / 2.0, newGeometry.height() / 2.0);
+            m_cameraPlaced = true;
+        }
+        m_layoutWorker->post(SetBoundsCommand{newGeometry.size()});
+        update();
     }
+}
 
-    const double w = width();
-    const double h = height();
+SceneView GraphViewItem::sceneView() const {
+    SceneView view;
+    view.camera = m_camera;
+    view.size = size();
+    view.nodeRadius = nodeRadius;
+    view.selection = &m_selectionMask;
+    view.rubberBand = m_rubberBand;
+    return view;
+}
 
-    // Integrate + damping
-    for (auto [nKey, node] : nodeData.asKeyValueRange()) {
-        if (ui.mode == UiContext::Mode::DraggingNode && nKey == ui.activeNodeId)
-            continue; // skip layout forces for this node
-        node.pos += node.velocity;
-        node.velocity *= 0.85;
+void GraphViewItem::itemChange(ItemChange change, const ItemChangeData &value) {
+    QQuickItem::itemChange(change, value);
+    if (change != ItemSceneChange) return;
 
-        // Constrain nodes fully inside the QML box
-        node.pos.setX(std::clamp(node.pos.x(), nodeRadius + boundaryThreshold, w - (nodeRadius + boundaryThreshold)));
-        node.pos.setY(std::clamp(node.pos.y(), nodeRadius + boundaryThreshold, h - (nodeRadius + boundaryThreshold)));
+    if (m_window) {
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+    m_window = value.window;
+    if (m_window) {
+        connect(m_window, &QQuickWindow::beforeSynchronizing,
+                this, &GraphViewItem::onBeforeSynchronizing, Qt::DirectConnection);
+        connect(m_window, &QQuickWindow::afterAnimating,
+                this, &GraphViewItem::onAfterAnimating);
     }
+}
 
-    update(); // trigger repaint
+void GraphViewItem::onBeforeSynchronizing() {
+    m_syncTime = m_layoutWorker->clockNs();
 }
 
-void GraphViewItem::paint(QPainter *painter)
-{
-    painter->setRenderHint(QPainter::Antialiasing);
+void GraphViewItem::onAfterAnimating() {
+    // Blending needs a repaint per window frame, not per simulation step;
+    // this keeps the window's render loop going until the layout rests.
+    if (m_simulationState == SimulationState::Running) {
+        update();
+    }
+}
 
-    const SessionCollaborations collabs = m_artistService->collabs();
-    // Draw edges
-    for (const auto &e : std::as_const(collabs)) {
-        QString artistId1 = e.first.a, artistId2 = e.first.b;
-        int sharedReleasesCount = e.second.size();
-        painter->setPen(QPen(Qt::gray, std::min(8.0, 1.0 + sharedReleasesCount * 0.5)));
+void GraphViewItem::onFrameReady() {
+    if (!m_layoutWorker->acquireFrame()) return;
 
-        painter->drawLine(nodeData[artistId1].pos, nodeData[artistId2].pos);
+    const LayoutFrame& frame = m_layoutWorker->frame();
+    m_nodeIndexStale = true;
+    if (frame.topology != m_selectionTopology) {
+        rebuildSelectionMask();
     }
 
-    // Draw nodes
-    for (const auto &n : std::as_const(nodeData)) {
-        painter->setBrush(Qt::white);
-        painter->setPen(Qt::black);
-        painter->drawEllipse(n.pos, nodeRadius, nodeRadius);
+    if (m_kineticEnergy != frame.kineticEnergy) {
+        m_kineticEnergy = frame.kineticEnergy;
+        emit kineticEnergyChanged();
+    }
+    const SimulationState state = frame.sleeping ? SimulationState::Sleeping : SimulationState::Running;
+    if (state != m_simulationState) {
+        m_simulationState = state;
+        emit simulationStateChanged();
+        if (state == SimulationState::Sleeping) {
+            saveLayoutPositions();
+        }
     }
 
-    // Draw names
-    for (const auto &n : std::as_const(nodeData)) {
-        painter->drawText(n.pos.x()-nodeRadius/2, n.pos.y()-nodeRadius-5, n.name);
+    update(); // trigger repaint
+}
+
+QSGNode *GraphViewItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    // Runs on the render thread while the GUI thread is blocked, so reading
+    // the worker's front frame is safe here.
+    auto *scene = static_cast<GraphSceneNode*>(oldNode);
+    if (!scene) {
+        scene = new GraphSceneNode(window());
     }
+    const LayoutFrame& frame = m_layoutWorker->frame();
+    SceneView view = sceneView();
+    view.blend = frame.blendAt(m_syncTime);
+    scene->update(frame, view);
+    return scene;
 }
 
 void GraphViewItem::setArtistService(ArtistService *artistService) {
     m_artistService = artistService;
+    // Keyed by the DB id: most saved artists are never added to this
+    // session, so they are not interned.
+    m_savedPositions = m_artistService->layoutPositions();
     this->connectSessionEvents(m_artistService->sessionManager());
 
+    QObject::connect(m_artistService, &ArtistService::dbCleared,
+                     this, [this]() { m_savedPositions.clear(); });
+    // A layout still running at exit is saved as it is.
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                     this, &GraphViewItem::saveLayoutPositions);
+
 }
 
 void GraphViewItem::connectSessionEvents(const SessionManager *sessionManager) {
-    QObject::connect(sessionManager, &SessionManager::artistAdded,
-                    this, [this](const Artist& artist){
-                        this->addArtistNode(artist);
-
+    QObject::connect(sessionManager, &SessionManager::artistsAdded,
+                    this, [this, sessionManager](const QVector<ArtistKey>& keys){
+                        for (ArtistKey key : keys) {
+                            this->addArtistNode(*sessionManager->artist(sessionManager->handleOf(key)), key);
+                        }
                      });
     QObject::connect(sessionManager, &SessionManager::artistRemoved,
-                    this, [this](const Artist& artist){
-                        this->removeArtistNode(artist);
-                        this->finalizeGraphLayout();
+                    this, [this](const Artist&, ArtistKey key){
+                        this->removeArtistNode(key);
+                    });
+    QObject::connect(sessionManager, &SessionManager::collabsChanged,
+                     this, &GraphViewItem::updateEdges);
+    QObject::connect(sessionManager, &SessionManager::sessionCleared,
+                    this, [this](){
+                        setSelection({});
+                        m_layoutWorker->post(ClearCommand{});
                     });
 
 }
@@ -184,43 +287,70 @@ bool GraphViewItem::event(QEvent *ev)
     }
 
     // Fallback to base implementation for unhandled events
-    return QQuickPaintedItem::event(ev);
+    return QQuickItem::event(ev);
 }
 
 
 void GraphViewItem::mousePressEvent(QMouseEvent *event) {
     event->accept();
 
-    QString hitId = hitTestNode(event->pos());
-    if (!hitId.isEmpty() && event->button() == Qt::LeftButton) {
-        // Start dragging
+    const LayoutFrame& frame = m_layoutWorker->frame();
+    const int hit = hitTestNode(event->position());
+    const ArtistKey hitKey = hit >= 0 ? frame.topology->ids[hit] : IdTable::nullKey;
+    const bool shift = event->modifiers() & Qt::ShiftModifier;
+
+    if (hit >= 0 && event->button() == Qt::LeftButton && shift) {
+        // Shift+click toggles the node in the selection
+        QSet<ArtistKey> selection = m_selection;
+        if (!selection.remove(hitKey)) selection.insert(hitKey);
+        setSelection(std::move(selection));
+    } else if (hit >= 0 && event->button() == Qt::LeftButton) {
+        // Start dragging; pressing an unselected node selects only that node
+        if (!m_selectionMask[hit]) setSelection({hitKey});
         ui.mode = UiContext::Mode::DraggingNode;
-        ui.activeNodeId = hitId;
+        ui.activeNode = hitKey;
         ui.dragStartPos = event->position();
-        ui.dragOffset = nodeData[hitId].pos - event->position(); // anchor offset
-        qDebug() << "Dragging node started:" << hitId;
-    } else if (!hitId.isEmpty() && event->button() == Qt::RightButton) {
+        startGroupDrag(event->position());
+        qDebug() << "Dragging" << ui.dragIds.size() << "node(s) started at:" << frame.topology->names[hit];
+    } else if (hit >= 0 && event->button() == Qt::RightButton) {
         // Right click, future context menu
-        qDebug() << "Right-clicked node:" << hitId;
+        qDebug() << "Right-clicked node:" << frame.topology->names[hit];
+    } else if (event->button() == Qt::LeftButton && shift) {
+        // Shift+drag on empty space adds a rubber band area to the selection
+        ui.mode = UiContext::Mode::SelectingArea;
+        ui.dragStartPos = event->position();
+        m_areaBaseMask = m_selectionMask;
+        updateAreaSelection(event->position());
+    } else if (event->button() == Qt::LeftButton || event->button() == Qt::MiddleButton) {
+        // Drag on empty space pans the view; a left click also clears the selection
+        if (event->button() == Qt::LeftButton) setSelection({});
+        ui.mode = UiContext::Mode::PanningView;
+        ui.dragStartPos = event->position();
+        ui.dragOffset = m_camera.offset - event->position();
     }
 }
 
 void GraphViewItem::mouseMoveEvent(QMouseEvent *event) {
     event->accept();
 
-    if (ui.mode == UiContext::Mode::DraggingNode && !ui.activeNodeId.isEmpty()) {
-        // Move node relative to original drag offset
-        QPointF newPos = event->position() + ui.dragOffset;
-
-        // Constrain node within widget bounds
-        const double w = width();
-        const double h = height();
-        newPos.setX(std::clamp(newPos.x(), nodeRadius + boundaryThreshold, w - nodeRadius - boundaryThreshold));
-        newPos.setY(std::clamp(newPos.y(), nodeRadius + boundaryThreshold, h - nodeRadius - boundaryThreshold));
+    if (ui.mode == UiContext::Mode::DraggingNode && !ui.dragIds.isEmpty()) {
+        // Move every dragged node relative to its original offset to the cursor
+        const QPointF cursor = m_camera.toWorld(event->position());
+        MoveNodesCommand move;
+        move.artists = ui.dragIds;
+        move.positions.reserve(ui.dragOffsets.size());
+        for (const QPointF& offset : std::as_const(ui.dragOffsets)) {
+            move.positions.append(cursor + offset);
+        }
 
-        nodeData[ui.activeNodeId].pos = newPos;
-        nodeData[ui.activeNodeId].velocity = QPointF(0, 0); // stop passive-layout fighting
-        update(); // trigger repaint
+        // The simulation applies the move and publishes a frame right away.
+        m_layoutWorker->post(std::move(move));
+    } else if (ui.mode == UiContext::Mode::PanningView) {
+        // Only the camera moves; the simulation is not involved.
+        m_camera.offset = event->position() + ui.dragOffset;
+        update();
+    } else if (ui.mode == UiContext::Mode::SelectingArea) {
+        updateAreaSelection(event->position());
     }
 }
 
@@ -228,22 +358,125 @@ void GraphViewItem::mouseReleaseEvent(QMouseEvent *event) {
     event->accept();
 
     if (ui.mode == UiContext::Mode::DraggingNode && event->button() == Qt::LeftButton) {
-        // qDebug() << "Dragging node ended:" << ui.activeNodeId;
+        m_layoutWorker->post(ReleaseNodesCommand{ui.dragIds});
+    } else if (ui.mode == UiContext::Mode::SelectingArea) {
+        // Commit the mask built while dragging back into the id set
+        const LayoutFrame& frame = m_layoutWorker->frame();
+        QSet<ArtistKey> selection;
+        for (size_t i = 0; i < m_selectionMask.size(); ++i) {
+            if (m_selectionMask[i]) selection.insert(frame.topology->ids[int(i)]);
+        }
+        m_rubberBand = QRectF();
+        setSelection(std::move(selection));
+        update();
     }
-    ui.activeNodeId.clear();
+    ui.activeNode = IdTable::nullKey;
+    ui.dragIds.clear();
+    ui.dragOffsets.clear();
     ui.mode = UiContext::Mode::None;
 }
 
+void GraphViewItem::hoverMoveEvent(QHoverEvent *event) {
+    const bool overNode = hitTestNode(event->position()) >= 0;
+    if (overNode != m_hoveringNode) {
+        m_hoveringNode = overNode;
+        setCursor(overNode ? Qt::PointingHandCursor : Qt::ArrowCursor);
+    }
+}
+
+void GraphViewItem::wheelEvent(QWheelEvent *event) {
+    event->accept();
+
+    // One wheel notch (120 units) zooms by about 20%, anchored at the cursor.
+    const double factor = std::pow(1.2, event->angleDelta().y() / 120.0);
+    m_camera.zoomAt(event->position(), factor, minZoom, maxZoom);
+    update();
+}
+
 
-QString GraphViewItem::hitTestNode(const QPointF &pos) const {
-    for (auto it = nodeData.begin(); it != nodeData.end(); ++it) {
-        double dx = pos.x() - it.value().pos.x();
-        double dy = pos.y() - it.value().pos.y();
-        if (std::hypot(dx, dy) <= nodeRadius) {
-            return it.key(); // return artistId
+const SpatialGrid& GraphViewItem::nodeIndex() {
+    if (m_nodeIndexStale) {
+        const LayoutFrame& frame = m_layoutWorker->frame();
+        m_nodeIndex.build(frame.x.data(), frame.y.data(), int(frame.x.size()), nodeRadius * 2.0);
+        m_nodeIndexStale = false;
+    }
+    return m_nodeIndex;
+}
+
+int GraphViewItem::hitTestNode(const QPointF &pos) {
+    const QPointF world = m_camera.toWorld(pos);
+    return nodeIndex().nearest(world.x(), world.y(), sceneView().drawnNodeRadius());
+}
+
+// ###
+// Selection:
+// ###
+
+QStringList GraphViewItem::selectedArtistIds() const {
+    QStringList ids;
+    if (!m_artistService) return ids;
+    const IdTable& artistIds = m_artistService->sessionManager()->artistIds();
+    for (ArtistKey key : m_selection) {
+        ids.append(artistIds.toString(key));
+    }
+    return ids;
+}
+
+void GraphViewItem::setSelection(QSet<ArtistKey> selection) {
+    if (selection == m_selection) return;
+    m_selection = std::move(selection);
+    rebuildSelectionMask();
+    emit selectionChanged();
+    update();
+}
+
+void GraphViewItem::rebuildSelectionMask() {
+    const LayoutFrame& frame = m_layoutWorker->frame();
+    m_selectionTopology = frame.topology;
+    m_selectionMask.assign(frame.x.size(), 0);
+    if (!frame.topology || m_selection.isEmpty()) return;
+
+    // Drop ids of artists that left the graph.
+    QSet<ArtistKey> present;
+    for (qsizetype i = 0; i < frame.topology->ids.size(); ++i) {
+        if (m_selection.contains(frame.topology->ids[i])) {
+            m_selectionMask[i] = 1;
+            present.insert(frame.topology->ids[i]);
         }
     }
-    return {};
+    if (ui.mode == UiContext::Mode::SelectingArea) {
+        m_areaBaseMask = m_selectionMask; // re-aligned; the next move re-adds the area
+    }
+    if (present.size() != m_selection.size()) {
+        m_selection = std::move(present);
+        emit selectionChanged();
+    }
 }
 
+void GraphViewItem::updateAreaSelection(const QPointF &pos) {
+    m_rubberBand = QRectF(ui.dragStartPos, pos).normalized();
+    const QPointF topLeft = m_camera.toWorld(m_rubberBand.topLeft());
+    const QPointF bottomRight = m_camera.toWorld(m_rubberBand.bottomRight());
+
+    m_areaHits.clear();
+    nodeIndex().queryRect(topLeft.x(), topLeft.y(), bottomRight.x(), bottomRight.y(), m_areaHits);
+
+    m_selectionMask = m_areaBaseMask;
+    m_selectionMask.resize(m_layoutWorker->frame().x.size(), 0);
+    for (int i : m_areaHits) {
+        m_selectionMask[i] = 1;
+    }
+    update();
+}
 
+void GraphViewItem::startGroupDrag(const QPointF &pos) {
+    const LayoutFrame& frame = m_layoutWorker->frame();
+    const QPointF cursor = m_camera.toWorld(pos);
+    ui.dragIds.clear();
+    ui.dragOffsets.clear();
+    for (size_t i = 0; i < m_selectionMask.size(); ++i) {
+        if (!m_selectionMask[i]) continue;
+        ui.dragIds.append(frame.topology->ids[int(i)]);
+        ui.dragOffsets.append(QPointF(frame.x[i], frame.y[i]) - cursor); // anchor offset
+    }
+}
@@ -1,25 +1,22 @@
 #pragma once
 #include <QObject>
-#include <QQuickPaintedItem>
-#include <QQuickPaintedItem>
-#include <QTimer>
+#include <QQuickItem>
+#include <QThread>
 #include <QPointF>
 #include <QLineF>
 #include <QVector>
 #include <QMap>
 #include <QPair>
+#include <QHash>
+#include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QRandomGenerator>
 #include "sessionmanager.h"
 #include "artistservice.h"
-
-struct ArtistNode {
-    // TODO: SessionArtist artist;
-    QString name;
-    QPointF pos;
-    QPointF velocity;
-};
-
+#include "layoutworker.h"
+#include "graphscenenode.h"
+#include "spatialgrid.h"
 
 
 struct UiContext {
@@ -32,47 +29,152 @@ struct UiContext {
     };
 
     Mode mode = Mode::None;
-    QString activeNodeId;
+    ArtistKey activeNode = IdTable::nullKey;
     QPointF dragStartPos;
-    QPointF dragOffset;
+    QPointF dragOffset; // camera offset while panning
+
+    // Group drag: every dragged node and its world offset to the cursor.
+    QVector<ArtistKey> dragIds;
+    QVector<QPointF> dragOffsets;
 };
 
 
-class GraphViewItem : public QQuickPaintedItem {
+class GraphViewItem : public QQuickItem {
     Q_OBJECT
+    Q_PROPERTY(LayoutAlgorithm layoutAlgorithm READ layoutAlgorithm WRITE setLayoutAlgorithm NOTIFY layoutAlgorithmChanged)
+    Q_PROPERTY(RepulsionMode repulsionMode READ repulsionMode WRITE setRepulsionMode NOTIFY repulsionModeChanged)
+    Q_PROPERTY(double theta READ theta WRITE setTheta NOTIFY thetaChanged)
+    Q_PROPERTY(int activeHops READ activeHops WRITE setActiveHops NOTIFY activeHopsChanged)
+    Q_PROPERTY(SimulationState simulationState READ simulationState NOTIFY simulationStateChanged)
+    Q_PROPERTY(double kineticEnergy READ kineticEnergy NOTIFY kineticEnergyChanged)
+    Q_PROPERTY(QStringList selectedArtistIds READ selectedArtistIds NOTIFY selectionChanged)
 
 public:
+    // Exact: O(n^2) pairwise pass, for small graphs and accuracy checks.
+    // BarnesHut: O(n log n) quadtree approximation controlled by theta.
+    // Auto: exact below barnesHutThreshold nodes, Barnes-Hut above.
+    enum class RepulsionMode { Exact, BarnesHut, Auto };
+    Q_ENUM(RepulsionMode)
+
+    // Mirrors ::LayoutModel, see layoutengine.h.
+    enum class LayoutAlgorithm { Springs, FruchtermanReingold, ForceAtlas2, StressMajorization };
+    Q_ENUM(LayoutAlgorithm)
+
+    // Sleeping: the layout converged, so neither the simulation nor repaints run
+    // until an artist is added/removed, a node is dragged or the item resized.
+    enum class SimulationState { Running, Sleeping };
+    Q_ENUM(SimulationState)
+
     explicit GraphViewItem(QQuickItem *parent = nullptr);
-    void paint(QPainter *painter) override;
+    ~GraphViewItem() override;
     void setArtistService(ArtistService *artistService);
 
+    LayoutAlgorithm layoutAlgorithm() const { return m_layoutAlgorithm; }
+    void setLayoutAlgorithm(LayoutAlgorithm algorithm);
+    RepulsionMode repulsionMode() const { return m_repulsionMode; }
+    void setRepulsionMode(RepulsionMode mode);
+    double theta() const { return m_layoutParams.theta; }
+    void setTheta(double theta);
+    // Hop radius of the active set simulated after a local change; 0 simulates everything.
+    int activeHops() const { return m_layoutParams.activeHops; }
+    void setActiveHops(int hops);
+    SimulationState simulationState() const { return m_simulationState; }
+    double kineticEnergy() const { return m_kineticEnergy; }
+    QStringList selectedArtistIds() const;
+
+    // Lays the whole graph out again with the multilevel engine.
+    Q_INVOKABLE void relayout();
+
+signals:
+    void layoutAlgorithmChanged();
+    void repulsionModeChanged();
+    void thetaChanged();
+    void activeHopsChanged();
+    void simulationStateChanged();
+    void kineticEnergyChanged();
+    void selectionChanged();
+
 private slots:
-    void updateLayout();
+    void onFrameReady();
+    void onBeforeSynchronizing();
+    void onAfterAnimating();
 
 private:
     void connectSessionEvents(const SessionManager *sessionManager);
-    void addArtistNode(const Artist& sessionArtist);
-    void removeArtistNode(const Artist& sessionArtist);
-    void finalizeGraphLayout();
+    void addArtistNode(const Artist& sessionArtist, ArtistKey key);
+    void removeArtistNode(ArtistKey key);
+    void updateEdges(const CollabDelta& delta);
+    void pushLayoutParams();
+    void saveLayoutPositions();
+
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
 
     // mouse events:
     bool event(QEvent *ev) override;
-    QString hitTestNode(const QPointF &pos) const;
+    int hitTestNode(const QPointF &pos); // index into the current frame, or -1
+    const SpatialGrid& nodeIndex();
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
-
-    QMap<QString, ArtistNode> nodeData; // artistId as key.
-
-
-    QTimer timer;
-    double repulsion = 2000.0;
-    double springLength = 100.0;
-    double springStrength = 0.01;
+    void hoverMoveEvent(QHoverEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    SceneView sceneView() const;
+
+    // selection:
+    void setSelection(QSet<ArtistKey> selection);
+    void rebuildSelectionMask();
+    void updateAreaSelection(const QPointF &pos);
+    void startGroupDrag(const QPointF &pos);
+
+    // The simulation runs on m_layoutThread; this item only posts commands
+    // to it and renders the latest frame it published.
+    QThread m_layoutThread;
+    LayoutWorker* m_layoutWorker;
+
+    // While the simulation runs the item repaints on every frame of its
+    // window, drawing the layout blended between its last two steps as of
+    // the moment the frame is synchronized (render thread, GUI blocked).
+    QQuickWindow* m_window = nullptr;
+    qint64 m_syncTime = 0; // LayoutWorker::clockNs()
+
+    LayoutParams m_layoutParams;
     double nodeRadius = 20.0;
-    double boundaryThreshold = 30.0;
 
-    ArtistService* m_artistService;
+    Camera m_camera;
+    bool m_cameraPlaced = false; // centred on the world origin once the item has a size
+    double minZoom = 0.02;
+    double maxZoom = 5.0;
+
+    LayoutAlgorithm m_layoutAlgorithm = LayoutAlgorithm::Springs;
+    RepulsionMode m_repulsionMode = RepulsionMode::Auto;
+    SimulationState m_simulationState = SimulationState::Running;
+    double m_kineticEnergy = 0.0;
+    int barnesHutThreshold = 200;
+
+    ArtistService* m_artistService = nullptr;
+
+    // Layout positions as last saved to the DB. Artists found here are added
+    // at their saved spot, so a reopened session shows its finished layout
+    // right away; the current frame is written back whenever it comes to rest.
+    // Keyed by artist id, see setArtistService().
+    QHash<QString, QPointF> m_savedPositions;
+
+    // Spatial index over the current frame's positions, rebuilt lazily the
+    // first time a query needs it after a new frame arrived.
+    SpatialGrid m_nodeIndex;
+    bool m_nodeIndexStale = true;
+    bool m_hoveringNode = false;
+
+    // Selected artists, and the same selection as a per-node mask aligned
+    // with the current frame (rebuilt when the topology changes).
+    QSet<ArtistKey> m_selection;
+    std::vector<char> m_selectionMask;
+    std::shared_ptr<const LayoutTopology> m_selectionTopology;
+    std::vector<char> m_areaBaseMask; // selection before the rubber band started
+    QRectF m_rubberBand;              // screen space, null when not selecting
+    std::vector<int> m_areaHits;
 
     UiContext ui;
 
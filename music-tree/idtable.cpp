@@ -0,0 +1,19 @@
+#include "idtable.h"
+
+quint32 IdTable::intern(const QString& id) {
+    const auto it = m_keys.constFind(id);
+    if (it != m_keys.constEnd()) return it.value();
+
+    const quint32 key = quint32(m_ids.size());
+    m_ids.append(id);
+    m_keys.insert(id, key);
+    return key;
+}
+
+qsizetype IdTable::memoryEstimate() const {
+    qsizetype bytes = 0;
+    for (const QString& id : m_ids) {
+        bytes += stringHeapBytes(id) + qsizetype(2 * sizeof(QString) + sizeof(quint32));
+    }
+    return bytes;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Rough heap use of a QString: header plus UTF-16 payload; an estimate,
+// not Qt's exact layout.
+inline qsizetype stringHeapBytes(const QString& s) {
+    return s.isEmpty() ? 0 : qsizetype(sizeof(QArrayData)) + (s.capacity() + 1) * qsizetype(sizeof(QChar));
+}
+
+// Interns string ids (Discogs artist or release ids) as dense 32-bit keys:
+// the first id interned gets 0, the next 1 and so on. Keys are never
+// reused, so a key keeps naming the same id for the table's lifetime and
+// can index plain arrays. Not thread-safe; the session's tables are only
+// used on the GUI thread.
+class IdTable {
+public:
+    static constexpr quint32 nullKey = ~quint32(0);
+
+    // The id's key, assigning the next one if the id is new.
+    quint32 intern(const QString& id);
+    // The id's key, or nullKey if it was never interned.
+    quint32 find(const QString& id) const { return m_keys.value(id, nullKey); }
+    const QString& toString(quint32 key) const { return m_ids[key]; }
+
+    int size() const { return int(m_ids.size()); }
+    // Rough heap use in bytes: each id's text, shared by both containers,
+    // and its two entries.
+    qsizetype memoryEstimate() const;
+
+private:
+    QHash<QString, quint32> m_keys;
+    QVector<QString> m_ids; // by key
+};
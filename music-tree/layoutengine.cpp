@@ -0,0 +1,101 @@
+#include "layoutengine.h"
+#include <limits>
+#include "barneshut.h"
+#include "forcelayout.h"
+#include "stresslayout.h"
+
+namespace {
+
+// The original model: inverse-square repulsion, Hooke springs towards
+// springLength, linear gravity and damped momentum. Runs on the vectorized
+// kernels; LayoutWorker::stepActive() is its active-set counterpart.
+class SpringLayout final : public LayoutEngine {
+public:
+    SpringLayout(const ForceKernels::KernelTable& kernels, ForcePool& pool) : m_kernels(kernels), m_pool(pool) {}
+
+    const char* name() const override { return "Springs"; }
+
+    void restart(const LayoutStore&, const LayoutParams&, bool) override {}
+
+    void step(LayoutStore& store, const LayoutParams& params) override {
+        const int n = store.size();
+        double* x = store.x.data();
+        double* y = store.y.data();
+        double* vx = store.vx.data();
+        double* vy = store.vy.data();
+
+        // Repulsion: each node only sums into its own velocity, so node
+        // blocks can go to whichever thread is free.
+        if (n > params.barnesHutThreshold) {
+            m_tree.build(x, y, n);
+            m_pool.forBlocks(n, treeBlock, [&](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    m_tree.accumulateForce(i, params.repulsion, params.theta, vx[i], vy[i]);
+                }
+            });
+        } else {
+            m_pool.forBlocks(n, exactBlock, [&](int begin, int end) {
+                m_kernels.repulse(x, y, n, begin, end, params.repulsion, vx, vy);
+            });
+        }
+
+        // Springs: an edge pushes both its ends, so every thread sums its
+        // slice of the edges into its own buffer.
+        const int* edgeA = store.edgeA.data();
+        const int* edgeB = store.edgeB.data();
+        if (m_pool.threadCount() == 1) {
+            m_kernels.springs(x, y, edgeA, edgeB, store.edgeCount(),
+                              params.springStrength, params.springLength, vx, vy);
+        } else {
+            m_springForces.reset(m_pool.threadCount(), n);
+            m_pool.forSlices(store.edgeCount(), [&](int thread, int begin, int end) {
+                m_springForces.clear(thread);
+                m_kernels.springs(x, y, edgeA + begin, edgeB + begin, end - begin,
+                                  params.springStrength, params.springLength,
+                                  m_springForces.fx(thread), m_springForces.fy(thread));
+            });
+            m_springForces.addTo(m_pool, vx, vy);
+        }
+
+        // Gravity, cap the step, integrate + damping. World coordinates are
+        // unbounded; the camera decides what is visible.
+        const double inf = std::numeric_limits<double>::infinity();
+        m_pool.forBlocks(n, moveBlock, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                vx[i] -= params.gravity * x[i];
+                vy[i] -= params.gravity * y[i];
+                capStep(vx[i], vy[i], params.maxStep);
+            }
+            m_kernels.integrate(x + begin, y + begin, vx + begin, vy + begin, end - begin,
+                                params.damping, -inf, inf, -inf, inf);
+        });
+    }
+
+private:
+    // Nodes per block handed to a thread.
+    static constexpr int treeBlock = 256;
+    static constexpr int exactBlock = 32;
+    static constexpr int moveBlock = 4096;
+
+    const ForceKernels::KernelTable& m_kernels;
+    ForcePool& m_pool;
+    BarnesHutTree m_tree;
+    PerThreadForces m_springForces;
+};
+
+} // namespace
+
+std::unique_ptr<LayoutEngine> createLayoutEngine(LayoutModel model, const ForceKernels::KernelTable& kernels,
+                                                 ForcePool& pool) {
+    switch (model) {
+    case LayoutModel::Springs:
+        return std::make_unique<SpringLayout>(kernels, pool);
+    case LayoutModel::FruchtermanReingold:
+        return std::make_unique<ForceLayout<FruchtermanReingoldForces, UnitEdgeWeight>>(pool);
+    case LayoutModel::ForceAtlas2:
+        return std::make_unique<ForceLayout<ForceAtlas2Forces, LogEdgeWeight>>(pool);
+    case LayoutModel::StressMajorization:
+        return std::make_unique<StressLayout<UnitEdgeWeight>>();
+    }
+    return std::make_unique<SpringLayout>(kernels, pool);
+}
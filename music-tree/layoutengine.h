@@ -0,0 +1,100 @@
+#pragma once
+#include <cmath>
+#include <memory>
+#include "forcekernels.h"
+#include "forcepool.h"
+#include "layoutstore.h"
+
+// Layout algorithms the simulation can run. Springs is the original model
+// (inverse-square repulsion, Hooke springs, momentum) and the only one with
+// active-set simulation; the others always step the whole graph.
+enum class LayoutModel {
+    Springs,
+    FruchtermanReingold, // k^2/d repulsion, d^2/k attraction, cooling step limit
+    ForceAtlas2,         // degree-weighted repulsion, linear attraction, adaptive speed
+    StressMajorization   // sparse stress towards graph distances, no forces
+};
+
+struct LayoutParams {
+    LayoutModel model = LayoutModel::Springs;
+
+    double repulsion = 2000.0;
+    double springLength = 100.0;  // ideal edge length for every model
+    double springStrength = 0.01;
+    double damping = 0.85;
+    double theta = 0.8;
+    int barnesHutThreshold = 200; // quadtree repulsion above this many nodes
+    int threads = 0;              // force computation threads, 0 for one per core
+    double gravity = 0.0005;      // weak pull towards the world origin keeps components together
+    double maxStep = 20.0;        // per-step displacement cap; two nodes meeting at close range
+                                  // otherwise kick each other across the graph
+
+    // Simulated time per step. The constants above are per step, so this
+    // sets how fast the layout moves in wall time, whatever the frame rate.
+    // A tick more than maxCatchUpSteps behind drops the rest: an overloaded
+    // machine then lays out slower instead of falling ever further behind.
+    int stepInterval = 30; // ms
+    int maxCatchUpSteps = 4;
+
+    // A multilevel layout places the whole graph at once when at least this
+    // many nodes arrived unplaced and they make up at least half the graph
+    // (e.g. a session being loaded).
+    int multilevelMinNodes = 200;
+
+    // Active-set mode: after a local change to a resting graph (an artist
+    // added or removed, collaborations changed, a node dragged) only nodes
+    // within activeHops hops of the change, plus nodes still moving faster
+    // than activeSpeed, are simulated. The rest stay frozen but keep
+    // repelling. 0 always simulates the whole graph. Springs model only.
+    int activeHops = 2;
+    double activeSpeed = 0.5;
+
+    // The simulation goes to sleep once, for restTicks steps in a row, the mean
+    // squared per-node displacement stays below restEnergy and no node moves
+    // more than restDisplacement pixels.
+    double restEnergy = 0.01;
+    double restDisplacement = 0.1;
+    int restTicks = 10;
+};
+
+// One layout algorithm, run by LayoutWorker on the layout thread.
+// The worker owns the store, pinning of dragged nodes and rest detection;
+// an engine only advances the positions (and whatever velocity it keeps in
+// store.vx/vy) by one iteration.
+//
+// The force based engines are instances of ForceLayout<ForcePolicy,
+// EdgeWeightPolicy> (forcelayout.h) and stress majorization is
+// StressLayout<EdgeWeightPolicy> (stresslayout.h): the policies are
+// resolved at compile time, so the model's force laws inline into the
+// inner loops and only step() itself is a virtual call.
+class LayoutEngine {
+public:
+    virtual ~LayoutEngine() = default;
+
+    virtual const char* name() const = 0;
+
+    // Called before the next step once nodes or edges changed, the params
+    // changed or a relayout was asked for, but not for drags, which only
+    // pin nodes. Engines restart their step schedule here and rebuild what
+    // they derive from the edges when topologyChanged is set (node indices
+    // may have moved too).
+    virtual void restart(const LayoutStore& store, const LayoutParams& params, bool topologyChanged) = 0;
+
+    virtual void step(LayoutStore& store, const LayoutParams& params) = 0;
+};
+
+// Engines split their force phases over pool; see ForcePool for which
+// phases are reproducible. Stress majorization updates in place and runs on
+// the calling thread only.
+std::unique_ptr<LayoutEngine> createLayoutEngine(LayoutModel model, const ForceKernels::KernelTable& kernels,
+                                                 ForcePool& pool);
+
+// Scales (dx, dy) down to at most maxStep long.
+inline void capStep(double& dx, double& dy, double maxStep) {
+    const double length2 = dx * dx + dy * dy;
+    if (length2 > maxStep * maxStep) {
+        const double scale = maxStep / std::sqrt(length2);
+        dx *= scale;
+        dy *= scale;
+    }
+}
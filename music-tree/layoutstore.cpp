@@ -0,0 +1,156 @@
+#include "layoutstore.h"
+
+int LayoutStore::addNode(ArtistKey artist, const QString& name, QPointF pos) {
+    if (contains(artist)) return m_index[artist];
+
+    const int idx = size();
+    x.push_back(pos.x());
+    y.push_back(pos.y());
+    vx.push_back(0.0);
+    vy.push_back(0.0);
+    ids.append(artist);
+    names.append(name);
+    m_incident.emplace_back();
+    if (artist >= m_index.size()) m_index.resize(artist + 1, -1);
+    m_index[artist] = idx;
+    return idx;
+}
+
+bool LayoutStore::removeNode(ArtistKey artist) {
+    const int idx = indexOf(artist);
+    if (idx < 0) return false;
+    const int last = size() - 1;
+
+    // Drop incident edges, re-point edges of the node moving into 'idx'.
+    while (!m_incident[idx].empty()) {
+        removeEdgeAt(m_incident[idx].back());
+    }
+    if (idx != last) {
+        for (int e : m_incident[last]) {
+            if (edgeA[e] == last) edgeA[e] = idx;
+            if (edgeB[e] == last) edgeB[e] = idx;
+        }
+        m_incident[idx] = std::move(m_incident[last]);
+        x[idx] = x[last];
+        y[idx] = y[last];
+        vx[idx] = vx[last];
+        vy[idx] = vy[last];
+        ids[idx] = ids[last];
+        names[idx] = names[last];
+        m_index[ids[idx]] = idx;
+    }
+
+    m_incident.pop_back();
+    x.pop_back();
+    y.pop_back();
+    vx.pop_back();
+    vy.pop_back();
+    ids.removeLast();
+    names.removeLast();
+    m_index[artist] = -1;
+    return true;
+}
+
+void LayoutStore::clear() {
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    ids.clear();
+    names.clear();
+    edgeA.clear();
+    edgeB.clear();
+    edgeWeight.clear();
+    m_index.clear();
+    m_edgeIndex.clear();
+    m_incident.clear();
+    m_slotA.clear();
+    m_slotB.clear();
+}
+
+void LayoutStore::setEdges(const SessionCollaborations& collabs) {
+    edgeA.clear();
+    edgeB.clear();
+    edgeWeight.clear();
+    m_edgeIndex.clear();
+    m_slotA.clear();
+    m_slotB.clear();
+    for (std::vector<int>& incident : m_incident) incident.clear();
+    edgeA.reserve(collabs.size());
+    edgeB.reserve(collabs.size());
+    edgeWeight.reserve(collabs.size());
+
+    collabs.forEach([this](const CollabKey& key, const ArtistCollaboration& releases) {
+        const int a = indexOf(key.a);
+        const int b = indexOf(key.b);
+        if (a >= 0 && b >= 0) appendEdge(key, a, b, releases.size());
+    });
+}
+
+bool LayoutStore::addEdge(CollabKey key, double weight) {
+    const int a = indexOf(key.a);
+    const int b = indexOf(key.b);
+    if (a < 0 || b < 0 || m_edgeIndex.count(key)) return false;
+    appendEdge(key, a, b, weight);
+    return true;
+}
+
+bool LayoutStore::removeEdge(CollabKey key) {
+    const auto it = m_edgeIndex.find(key);
+    if (it == m_edgeIndex.end()) return false;
+    removeEdgeAt(it->second);
+    return true;
+}
+
+// Swap-removes edge e: the last edge takes over its position.
+void LayoutStore::removeEdgeAt(int e) {
+    m_edgeIndex.erase(CollabKey(ids[edgeA[e]], ids[edgeB[e]]));
+    unlinkIncident(edgeA[e], m_slotA[e]);
+    unlinkIncident(edgeB[e], m_slotB[e]);
+
+    const int last = edgeCount() - 1;
+    if (e != last) {
+        edgeA[e] = edgeA[last];
+        edgeB[e] = edgeB[last];
+        edgeWeight[e] = edgeWeight[last];
+        m_slotA[e] = m_slotA[last];
+        m_slotB[e] = m_slotB[last];
+        m_incident[edgeA[e]][m_slotA[e]] = e;
+        m_incident[edgeB[e]][m_slotB[e]] = e;
+        m_edgeIndex[CollabKey(ids[edgeA[e]], ids[edgeB[e]])] = e;
+    }
+    edgeA.pop_back();
+    edgeB.pop_back();
+    edgeWeight.pop_back();
+    m_slotA.pop_back();
+    m_slotB.pop_back();
+}
+
+// Swap-removes entry 'slot' of the node's incidence list.
+void LayoutStore::unlinkIncident(int node, int slot) {
+    std::vector<int>& incident = m_incident[node];
+    const int moved = incident.back();
+    incident[slot] = moved;
+    incident.pop_back();
+    if (slot < int(incident.size())) {
+        if (edgeA[moved] == node) m_slotA[moved] = slot;
+        else m_slotB[moved] = slot;
+    }
+}
+
+int LayoutStore::edgeIndex(CollabKey key) const {
+    const auto it = m_edgeIndex.find(key);
+    return it == m_edgeIndex.end() ? -1 : it->second;
+}
+
+void LayoutStore::appendEdge(CollabKey key, int a, int b, double weight) {
+    const int e = edgeCount();
+    m_edgeIndex[key] = e;
+    edgeA.push_back(a);
+    edgeB.push_back(b);
+    edgeWeight.push_back(weight);
+    m_slotA.push_back(int(m_incident[a].size()));
+    m_slotB.push_back(int(m_incident[b].size()));
+    m_incident[a].push_back(e);
+    m_incident[b].push_back(e);
+}
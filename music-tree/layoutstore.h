@@ -0,0 +1,69 @@
+#pragma once
+#include <QPointF>
+#include <QString>
+#include <QVector>
+#include <unordered_map>
+#include <vector>
+#include "artist.h"
+
+// Structure-of-arrays node store for the force layout.
+// Every node gets a dense index in [0, size()); positions, velocities and
+// edge endpoints are plain arrays addressed by that index, so the force
+// loops never touch a QString. Nodes are named by the session's interned
+// ArtistKey; names are only kept for painting labels.
+class LayoutStore {
+public:
+    int size() const { return int(x.size()); }
+    int edgeCount() const { return int(edgeA.size()); }
+
+    int indexOf(ArtistKey artist) const { return artist < m_index.size() ? m_index[artist] : -1; }
+    bool contains(ArtistKey artist) const { return indexOf(artist) >= 0; }
+
+    // Returns the dense index of the new node, or the existing one if already present.
+    int addNode(ArtistKey artist, const QString& name, QPointF pos);
+    // Swap-removes the node: the last node takes over its index.
+    // Edges touching the node are dropped and the moved node's edges
+    // re-pointed, so the cost follows the two nodes' degrees.
+    bool removeNode(ArtistKey artist);
+    void clear();
+
+    // Rebuilds the edge arrays from the session collaborations.
+    // Collaborations whose endpoints are not (yet) in the store are skipped.
+    void setEdges(const SessionCollaborations& collabs);
+
+    // Single-edge updates, O(1). addEdge() skips edges with a missing
+    // endpoint or already present; removeEdge() swap-removes like removeNode().
+    bool addEdge(CollabKey key, double weight);
+    bool removeEdge(CollabKey key);
+    // The edge's position in the edge arrays, or -1.
+    int edgeIndex(CollabKey key) const;
+
+    // Positions of the edges touching node i, in no particular order.
+    const std::vector<int>& incidentEdges(int i) const { return m_incident[i]; }
+
+    QPointF position(int i) const { return QPointF(x[i], y[i]); }
+    void setPosition(int i, QPointF pos) { x[i] = pos.x(); y[i] = pos.y(); }
+
+    // Node arrays, all of length size().
+    std::vector<double> x, y;
+    std::vector<double> vx, vy;
+    QVector<ArtistKey> ids;
+    QVector<QString> names;
+
+    // Edge arrays, all of length edgeCount().
+    std::vector<int> edgeA, edgeB;
+    std::vector<double> edgeWeight; // number of shared releases
+
+private:
+    void appendEdge(CollabKey key, int a, int b, double weight);
+    void removeEdgeAt(int e);
+    void unlinkIncident(int node, int slot);
+
+    // Per node, the edges touching it; per edge, where it sits in its two
+    // endpoints' lists, so an edge is unlinked without searching.
+    std::vector<std::vector<int>> m_incident;
+    std::vector<int> m_slotA, m_slotB;
+
+    std::vector<int> m_index; // by ArtistKey, the dense index or -1
+    std::unordered_map<CollabKey, int, CollabKeyHash> m_edgeIndex; // edge position by its endpoints
+};
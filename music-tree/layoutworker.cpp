@@ -0,0 +1,793 @@
+#include "layoutworker.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QLineF>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QtMath>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+Q_LOGGING_CATEGORY(lcLayout, "music_tree.layout", QtWarningMsg)
+
+LayoutWorker::LayoutWorker(QObject* parent)
+    : QObject(parent), m_timer(this), m_kernels(ForceKernels::best())
+{
+    m_clock.start();
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &LayoutWorker::tick);
+    m_engine = createLayoutEngine(m_params.model, m_kernels, m_forcePool);
+    qCDebug(lcLayout) << "Layout force kernels:" << m_kernels.name << "on" << m_forcePool.threadCount() << "threads";
+}
+
+void LayoutWorker::start() {
+    // Twice per step, so no step is due for more than half an interval
+    // before it runs.
+    m_timer.setInterval(std::max(1, m_params.stepInterval / 2));
+    m_lastTick = m_clock.nsecsElapsed();
+    m_timer.start();
+}
+
+void LayoutWorker::post(LayoutCommand command) {
+    {
+        QMutexLocker locker(&m_commandMutex);
+        m_pending.push_back(std::move(command));
+    }
+
+    // Apply commands right away instead of waiting for the next tick, so a
+    // drag shows up in the next frame. Several posts share one flush.
+    if (!m_flushQueued.exchange(true)) {
+        QMetaObject::invokeMethod(this, &LayoutWorker::flushCommands, Qt::QueuedConnection);
+    }
+}
+
+void LayoutWorker::flushCommands() {
+    if (applyCommands()) {
+        publishFrame();
+    }
+}
+
+void LayoutWorker::tick() {
+    const bool applied = applyCommands();
+
+    const qint64 now = m_clock.nsecsElapsed();
+    const qint64 stepNs = qint64(m_params.stepInterval) * 1000000;
+    m_accumulated += now - m_lastTick;
+    m_lastTick = now;
+    qint64 steps = m_accumulated / stepNs;
+    if (steps > m_params.maxCatchUpSteps) {
+        steps = m_params.maxCatchUpSteps;
+        m_accumulated = steps * stepNs;
+    }
+    m_accumulated -= steps * stepNs;
+
+    for (qint64 k = 0; k < steps && !m_sleeping; ++k) {
+        simulate();
+    }
+    if (steps > 0) {
+        m_stepTime = now - m_accumulated;
+    }
+    if (steps > 0 || applied) {
+        publishFrame();
+    }
+}
+
+void LayoutWorker::simulate() {
+    m_placementGridValid = false; // everything is about to move
+    if (wantsMultilevel()) {
+        runMultilevel();
+    }
+    if (m_activeMode && m_prevFrozenCurrent) {
+        // Frozen nodes have not moved since the last copy.
+        for (int i : m_activeNodes) {
+            m_prevX[i] = m_store.x[i];
+            m_prevY[i] = m_store.y[i];
+            markFrameChanged(i);
+        }
+    } else {
+        m_prevX = m_store.x;
+        m_prevY = m_store.y;
+        m_prevFrozenCurrent = m_activeMode;
+        m_frameAllChanged = true;
+    }
+    if (m_activeMode) {
+        stepActive();
+    } else {
+        step();
+        measureMotion();
+    }
+
+    const int simulated = m_activeMode ? int(m_activeNodes.size()) : m_store.size();
+    const bool atRest = m_kineticEnergy <= m_params.restEnergy * std::max(1, simulated)
+                        && m_maxDisplacement <= m_params.restDisplacement;
+    m_restTicks = atRest ? m_restTicks + 1 : 0;
+    if (m_restTicks >= m_params.restTicks && m_dragged.empty()) {
+        sleep();
+    }
+}
+
+void LayoutWorker::sleep() {
+    m_timer.stop();
+    m_sleeping = true;
+    m_prevX = m_store.x; // nothing left to blend
+    m_prevY = m_store.y;
+    m_frameAllChanged = true;
+    m_activeMode = false;
+    qCDebug(lcLayout) << "Graph layout at rest, simulation suspended";
+}
+
+void LayoutWorker::wake() {
+    m_restTicks = 0;
+    if (!m_sleeping) return;
+    m_sleeping = false;
+    m_lastTick = m_clock.nsecsElapsed();
+    m_accumulated = 0;
+    m_timer.start();
+}
+
+void LayoutWorker::measureMotion() {
+    const int n = m_store.size();
+    double energy = 0.0;
+    double maxDisp2 = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const double dx = m_store.x[i] - m_prevX[i];
+        const double dy = m_store.y[i] - m_prevY[i];
+        const double d2 = dx * dx + dy * dy;
+        energy += d2;
+        maxDisp2 = std::max(maxDisp2, d2);
+    }
+    m_kineticEnergy = energy;
+    m_maxDisplacement = std::sqrt(maxDisp2);
+}
+
+bool LayoutWorker::applyCommands() {
+    m_flushQueued = false;
+
+    std::vector<LayoutCommand> commands;
+    {
+        QMutexLocker locker(&m_commandMutex);
+        commands.swap(m_pending);
+    }
+
+    const bool wasSleeping = m_sleeping;
+    for (const LayoutCommand& command : commands) {
+        apply(command);
+    }
+    if (!commands.empty()) {
+        wake();
+    }
+
+    if (m_republishTopology) {
+        resolveDragged();
+        // Indices may have moved and new nodes appear where they were placed.
+        m_prevX = m_store.x;
+        m_prevY = m_store.y;
+        m_frameAllChanged = true;
+    }
+    if (!commands.empty()) {
+        // Restarting reheats the cooling engines, so moves and releases of
+        // dragged nodes, which only re-pin them, leave the schedule alone.
+        if (m_topologyDirty || m_restartEngine) {
+            m_engine->restart(m_store, m_params, m_topologyDirty);
+            m_restartEngine = false;
+        }
+        updateActiveSet(wasSleeping);
+    }
+    return !commands.empty();
+}
+
+void LayoutWorker::apply(const LayoutCommand& command) {
+    if (auto* add = std::get_if<AddNodeCommand>(&command)) {
+        if (!m_store.contains(add->artist)) {
+            m_store.addNode(add->artist, add->name, add->pos);
+            m_topologyDirty = true;
+            m_republishTopology = true;
+            if (add->restored) {
+                // Already laid out in an earlier session: it keeps its spot
+                // and does not disturb its neighbourhood.
+                m_restoredIds.insert(add->artist);
+                notePlaced(add->pos);
+            } else {
+                ++m_unplacedNodes;
+                m_awaitingPlacement.append(add->artist);
+                m_changedIds.insert(add->artist);
+            }
+        }
+    } else if (auto* remove = std::get_if<RemoveNodeCommand>(&command)) {
+        // The former collaborators are the ones that will move.
+        const int idx = m_store.indexOf(remove->artist);
+        if (idx >= 0) {
+            for (int e : m_store.incidentEdges(idx)) {
+                const int other = m_store.edgeA[e] == idx ? m_store.edgeB[e] : m_store.edgeA[e];
+                m_changedIds.insert(m_store.ids[other]);
+            }
+        }
+        m_restoredIds.remove(remove->artist);
+        if (m_store.removeNode(remove->artist)) {
+            m_topologyDirty = true;
+            m_republishTopology = true;
+        }
+        m_unplacedNodes = std::min(m_unplacedNodes, m_store.size());
+    } else if (auto* edges = std::get_if<UpdateEdgesCommand>(&command)) {
+        const quint64 generation = edges->delta.generation;
+        if (generation <= m_edgesGeneration) return; // already covered by a resync
+        if (generation == m_edgesGeneration + 1) {
+            applyEdgeDelta(edges->delta);
+            m_edgesGeneration = generation;
+        } else {
+            resyncEdges(edges->session->collabs);
+            m_edgesGeneration = edges->session->generation;
+        }
+        placeNewNodes();
+    } else if (auto* move = std::get_if<MoveNodesCommand>(&command)) {
+        for (qsizetype k = 0; k < move->artists.size(); ++k) {
+            const int idx = m_store.indexOf(move->artists[k]);
+            if (idx >= 0) {
+                m_store.setPosition(idx, move->positions[k]);
+                m_store.vx[idx] = 0.0; // stop passive-layout fighting
+                m_store.vy[idx] = 0.0;
+                if (size_t(idx) < m_prevX.size()) {
+                    m_prevX[idx] = m_store.x[idx]; // follows the cursor without blending
+                    m_prevY[idx] = m_store.y[idx];
+                }
+                markFrameChanged(idx);
+            }
+            m_draggedIds.insert(move->artists[k]);
+            m_changedIds.insert(move->artists[k]);
+            m_placementGridValid = false;
+            m_restoredIds.remove(move->artists[k]);
+        }
+        resolveDragged();
+    } else if (auto* release = std::get_if<ReleaseNodesCommand>(&command)) {
+        for (ArtistKey id : release->artists) {
+            m_draggedIds.remove(id);
+        }
+        resolveDragged();
+    } else if (auto* params = std::get_if<SetParamsCommand>(&command)) {
+        if (params->params.model != m_params.model) {
+            m_engine = createLayoutEngine(params->params.model, m_kernels, m_forcePool);
+            // Velocities mean something else to each engine.
+            std::fill(m_store.vx.begin(), m_store.vx.end(), 0.0);
+            std::fill(m_store.vy.begin(), m_store.vy.end(), 0.0);
+            qCDebug(lcLayout) << "Layout engine:" << m_engine->name();
+        }
+        if (params->params.threads != m_params.threads) {
+            m_forcePool.setThreadCount(params->params.threads);
+        }
+        if (params->params.stepInterval != m_params.stepInterval) {
+            m_timer.setInterval(std::max(1, params->params.stepInterval / 2));
+        }
+        m_params = params->params;
+        m_fullChange = true;
+        m_restartEngine = true;
+    } else if (std::holds_alternative<RelayoutCommand>(command)) {
+        m_relayoutRequested = true;
+        m_fullChange = true;
+        m_restartEngine = true;
+    } else if (std::holds_alternative<ClearCommand>(command)) {
+        clear();
+    }
+}
+
+// The session's edge generation is kept: the cleared session's delta,
+// removing the edges already dropped here, follows as usual.
+void LayoutWorker::clear() {
+    m_store.clear();
+    m_awaitingPlacement.clear();
+    m_restoredIds.clear();
+    m_changedIds.clear();
+    m_draggedIds.clear();
+    m_dragged.clear();
+    m_unplacedNodes = 0;
+    m_relayoutRequested = false;
+    m_activeMode = false;
+    m_activeNodes.clear();
+    m_isActive.clear();
+    m_placementGridValid = false;
+    m_prevX.clear();
+    m_prevY.clear();
+    m_frameChanged.clear();
+    m_inFrameChanged.clear();
+    m_frameAllChanged = true;
+    m_topologyDirty = true;
+    m_republishTopology = true;
+    m_fullChange = true;
+}
+
+
+// The changes also go to the renderer as they are, see LayoutFrame::edgeDelta.
+void LayoutWorker::applyEdgeDelta(const CollabDelta& delta) {
+    // Edges whose endpoints are not in the store were dropped with the node.
+    for (const CollabKey& key : delta.removed) {
+        const int e = m_store.edgeIndex(key);
+        if (e < 0) continue;
+        m_store.removeEdge(key);
+        m_edgeChanges.push_back({LayoutEdgeChange::Removed, e});
+        markEdgeChanged(key);
+    }
+    for (const CollabEdge& edge : delta.added) {
+        if (!m_store.addEdge(edge.key, edge.weight)) continue;
+        const int e = m_store.edgeCount() - 1;
+        m_edgeChanges.push_back({LayoutEdgeChange::Added, e, m_store.edgeA[e], m_store.edgeB[e], m_store.edgeWeight[e]});
+        markEdgeChanged(edge.key);
+    }
+}
+
+void LayoutWorker::resyncEdges(const SessionCollaborations& collabs) {
+    const auto edgeKeys = [this] {
+        std::vector<quint64> keys(m_store.edgeCount());
+        for (int e = 0; e < m_store.edgeCount(); ++e) {
+            const auto [a, b] = std::minmax(m_store.edgeA[e], m_store.edgeB[e]);
+            keys[e] = (quint64(a) << 32) | quint32(b);
+        }
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    };
+    const std::vector<quint64> before = edgeKeys();
+    m_store.setEdges(collabs);
+    m_topologyDirty = true;
+    m_republishTopology = true;
+
+    const std::vector<quint64> after = edgeKeys();
+    std::vector<quint64> changed;
+    std::set_symmetric_difference(before.begin(), before.end(), after.begin(), after.end(),
+                                  std::back_inserter(changed));
+    for (quint64 key : changed) {
+        markEdgeChanged(CollabKey(m_store.ids[int(key >> 32)], m_store.ids[int(key & 0xffffffffu)]));
+    }
+}
+
+// Endpoints of added or dropped edges are the ones that will move, except
+// for edges between restored nodes, which the saved layout already
+// accounts for.
+void LayoutWorker::markEdgeChanged(CollabKey key) {
+    m_topologyDirty = true;
+    if (m_restoredIds.contains(key.a) && m_restoredIds.contains(key.b)) return;
+    m_changedIds.insert(key.a);
+    m_changedIds.insert(key.b);
+}
+void LayoutWorker::placeNewNodes() {
+    if (m_awaitingPlacement.isEmpty()) return;
+
+    // New nodes in placement order; m_placementSlot[i] is node i's position
+    // in that order, -1 for nodes that already had a place and placedSlot
+    // once placed here. Only the entries of 'nodes' are set, and they are
+    // reset on the way out.
+    constexpr int placedSlot = -2;
+    const int n = m_store.size();
+    if (int(m_placementSlot.size()) < n) m_placementSlot.resize(n, -1);
+    std::vector<int>& slot = m_placementSlot;
+    std::vector<int> nodes;
+    for (ArtistKey id : std::as_const(m_awaitingPlacement)) {
+        const int idx = m_store.indexOf(id);
+        if (idx >= 0 && slot[idx] < 0) {
+            slot[idx] = int(nodes.size());
+            nodes.push_back(idx);
+        }
+    }
+    m_awaitingPlacement.clear();
+    if (nodes.empty()) return;
+
+    // Start each node at the barycenter of its collaborators that already
+    // have a position: nodes placed before, or new ones placed earlier in
+    // this pass. The jitter keeps artists sharing the same collaborators
+    // from landing on the same spot.
+    QRandomGenerator* rng = QRandomGenerator::global();
+    const double jitter = m_params.springLength * 0.25;
+    std::vector<int> isolated;
+    for (int idx : nodes) {
+        double sumX = 0.0, sumY = 0.0;
+        int count = 0;
+        for (int e : m_store.incidentEdges(idx)) {
+            const int nb = m_store.edgeA[e] == idx ? m_store.edgeB[e] : m_store.edgeA[e];
+            if (slot[nb] >= 0) continue; // new and not placed (yet)
+            sumX += m_store.x[nb];
+            sumY += m_store.y[nb];
+            ++count;
+        }
+        if (count == 0) {
+            isolated.push_back(idx);
+            continue;
+        }
+        slot[idx] = placedSlot;
+        m_store.setPosition(idx, QPointF(sumX / count + (rng->generateDouble() * 2.0 - 1.0) * jitter,
+                                         sumY / count + (rng->generateDouble() * 2.0 - 1.0) * jitter));
+        m_store.vx[idx] = m_store.vy[idx] = 0.0;
+        markFrameChanged(idx);
+        notePlaced(m_store.position(idx));
+    }
+
+    // Nodes without placed collaborators go to free space near where the
+    // GUI put them, so they neither overlap the graph nor each other.
+    if (!isolated.empty()) {
+        if (!m_placementGridValid || m_placedSinceGrid.size() > maxPlacedSinceGrid) {
+            m_placementX.clear();
+            m_placementY.clear();
+            for (int i = 0; i < n; ++i) {
+                if (slot[i] >= 0) continue; // isolated, still at the GUI's spot
+                m_placementX.push_back(m_store.x[i]);
+                m_placementY.push_back(m_store.y[i]);
+            }
+            m_placementGrid.build(m_placementX.data(), m_placementY.data(), int(m_placementX.size()),
+                                  m_params.springLength);
+            m_placedSinceGrid.clear();
+            m_placementGridValid = true;
+        }
+        for (int idx : isolated) {
+            const QPointF pos = openSpaceNear(m_store.position(idx));
+            m_store.setPosition(idx, pos);
+            m_store.vx[idx] = m_store.vy[idx] = 0.0;
+            markFrameChanged(idx);
+            m_placedSinceGrid.push_back(pos);
+        }
+    }
+
+    for (int idx : nodes) slot[idx] = -1;
+}
+
+// Nodes that got a position while the placement grid is kept are checked
+// one by one until it is rebuilt.
+void LayoutWorker::notePlaced(QPointF pos) {
+    if (m_placementGridValid) m_placedSinceGrid.push_back(pos);
+}
+
+QPointF LayoutWorker::openSpaceNear(QPointF pos) const {
+    const double clearance = m_params.springLength;
+    const auto isFree = [&](QPointF p) {
+        if (m_placementGrid.nearest(p.x(), p.y(), clearance) >= 0) return false;
+        for (const QPointF& other : m_placedSinceGrid) {
+            if (QLineF(p, other).length() < clearance) return false;
+        }
+        return true;
+    };
+
+    // The hint itself, then rings of growing radius around it.
+    if (isFree(pos)) return pos;
+    constexpr int rings = 6, perRing = 12;
+    for (int ring = 1; ring <= rings; ++ring) {
+        const double radius = ring * clearance;
+        const double phase = QRandomGenerator::global()->generateDouble() * 2.0 * M_PI;
+        for (int k = 0; k < perRing; ++k) {
+            const double angle = phase + k * 2.0 * M_PI / perRing;
+            const QPointF candidate = pos + QPointF(std::cos(angle), std::sin(angle)) * radius;
+            if (isFree(candidate)) return candidate;
+        }
+    }
+    return pos; // crowded everywhere nearby; the simulation will push it out
+}
+
+bool LayoutWorker::wantsMultilevel() const {
+    if (m_relayoutRequested) return true;
+    return m_unplacedNodes >= m_params.multilevelMinNodes && m_unplacedNodes * 2 >= m_store.size();
+}
+
+void LayoutWorker::runMultilevel() {
+    QElapsedTimer timer;
+    timer.start();
+
+    MultilevelLayout::Options options;
+    options.repulsion = m_params.repulsion;
+    options.springLength = m_params.springLength;
+    options.springStrength = m_params.springStrength;
+    options.gravity = m_params.gravity;
+    options.damping = m_params.damping;
+    options.theta = m_params.theta;
+    m_multilevel.run(m_store.x, m_store.y, m_store.edgeA, m_store.edgeB, m_store.edgeWeight, options);
+
+    std::fill(m_store.vx.begin(), m_store.vx.end(), 0.0);
+    std::fill(m_store.vy.begin(), m_store.vy.end(), 0.0);
+    m_unplacedNodes = 0;
+    m_relayoutRequested = false;
+    m_restoredIds.clear();
+    m_activeMode = false;
+
+    qCDebug(lcLayout) << "Multilevel layout of" << m_store.size() << "nodes in"
+                      << m_multilevel.levelCount() << "levels took" << timer.elapsed() << "ms";
+}
+
+void LayoutWorker::resolveDragged() {
+    m_dragged.clear();
+    for (ArtistKey id : std::as_const(m_draggedIds)) {
+        const int idx = m_store.indexOf(id);
+        if (idx >= 0) m_dragged.push_back(idx);
+    }
+}
+
+void LayoutWorker::applyGravityAndCap(int i) {
+    double& vx = m_store.vx[i];
+    double& vy = m_store.vy[i];
+    vx -= m_params.gravity * m_store.x[i];
+    vy -= m_params.gravity * m_store.y[i];
+    capStep(vx, vy, m_params.maxStep);
+}
+
+void LayoutWorker::savePinned() {
+    m_draggedPos.clear();
+    for (int i : m_dragged) {
+        m_draggedPos.push_back(m_store.position(i));
+    }
+}
+
+void LayoutWorker::restorePinned() {
+    for (size_t k = 0; k < m_dragged.size(); ++k) {
+        const int i = m_dragged[k];
+        m_store.setPosition(i, m_draggedPos[k]);
+        m_store.vx[i] = 0.0;
+        m_store.vy[i] = 0.0;
+    }
+}
+
+void LayoutWorker::step() {
+    // The engine moves every node; dragged nodes are put back afterwards so
+    // layout forces never move them.
+    savePinned();
+    m_engine->step(m_store, m_params);
+    restorePinned();
+}
+
+void LayoutWorker::updateActiveSet(bool wasSleeping) {
+    // Local changes to a resting (or already localized) simulation stay
+    // local; anything else runs the whole graph.
+    const bool local = m_params.model == LayoutModel::Springs && m_params.activeHops > 0
+                       && !m_fullChange && (wasSleeping || m_activeMode);
+    m_fullChange = false;
+    if (!local) {
+        m_activeMode = false;
+        m_changedIds.clear();
+        return;
+    }
+
+    // A drag keeps touching the same, already active nodes.
+    if (m_activeMode && !m_topologyDirty) {
+        const bool covered = std::all_of(m_changedIds.cbegin(), m_changedIds.cend(), [this](ArtistKey id) {
+            const int idx = m_store.indexOf(id);
+            return idx < 0 || m_isActive[idx];
+        });
+        if (covered) {
+            m_changedIds.clear();
+            return;
+        }
+    }
+
+    buildActiveSet();
+}
+
+void LayoutWorker::buildActiveSet() {
+    const int n = m_store.size();
+
+    m_isActive.assign(n, 0);
+    std::vector<int> frontier, next;
+    for (ArtistKey id : std::as_const(m_changedIds)) {
+        const int idx = m_store.indexOf(id);
+        if (idx >= 0 && !m_isActive[idx]) {
+            m_isActive[idx] = 1;
+            frontier.push_back(idx);
+        }
+    }
+    m_changedIds.clear();
+
+    for (int hop = 0; hop < m_params.activeHops && !frontier.empty(); ++hop) {
+        next.clear();
+        for (int u : frontier) {
+            for (int e : m_store.incidentEdges(u)) {
+                const int v = m_store.edgeA[e] == u ? m_store.edgeB[e] : m_store.edgeA[e];
+                if (!m_isActive[v]) {
+                    m_isActive[v] = 1;
+                    next.push_back(v);
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+
+    // Nodes still settling from earlier changes keep moving.
+    const double speed2 = m_params.activeSpeed * m_params.activeSpeed;
+    for (int i = 0; i < n; ++i) {
+        if (m_store.vx[i] * m_store.vx[i] + m_store.vy[i] * m_store.vy[i] > speed2) {
+            m_isActive[i] = 1;
+        }
+    }
+
+    m_activeNodes.clear();
+    for (int i = 0; i < n; ++i) {
+        if (m_isActive[i]) m_activeNodes.push_back(i);
+    }
+
+    // Touching most of the graph: a full step is cheaper than the bookkeeping.
+    if (int(m_activeNodes.size()) * 2 > n) {
+        m_activeMode = false;
+        return;
+    }
+
+    // An edge between two active nodes is taken from its lower endpoint.
+    m_activeEdges.clear();
+    for (int i : m_activeNodes) {
+        for (int e : m_store.incidentEdges(i)) {
+            const int other = m_store.edgeA[e] == i ? m_store.edgeB[e] : m_store.edgeA[e];
+            if (!m_isActive[other] || i < other) m_activeEdges.push_back(e);
+        }
+    }
+
+    m_frozenX.clear();
+    m_frozenY.clear();
+    for (int i = 0; i < n; ++i) {
+        if (m_isActive[i]) continue;
+        m_frozenX.push_back(m_store.x[i]);
+        m_frozenY.push_back(m_store.y[i]);
+        m_store.vx[i] = 0.0;
+        m_store.vy[i] = 0.0;
+    }
+    m_frozenTree.build(m_frozenX.data(), m_frozenY.data(), int(m_frozenX.size()));
+    m_activeMode = true;
+    m_prevFrozenCurrent = false; // nodes leaving the active set moved in the last step
+}
+
+void LayoutWorker::stepActive() {
+    const int count = int(m_activeNodes.size());
+    double* x = m_store.x.data();
+    double* y = m_store.y.data();
+    double* vx = m_store.vx.data();
+    double* vy = m_store.vy.data();
+
+    m_activeX.resize(count);
+    m_activeY.resize(count);
+    for (int k = 0; k < count; ++k) {
+        m_activeX[k] = x[m_activeNodes[k]];
+        m_activeY[k] = y[m_activeNodes[k]];
+    }
+    m_activeFx.assign(count, 0.0);
+    m_activeFy.assign(count, 0.0);
+
+    // Repulsion among the active nodes and from the frozen rest of the
+    // graph. Per node, so in node blocks on the force pool.
+    const bool useTree = count > m_params.barnesHutThreshold;
+    if (useTree) {
+        m_repulsionTree.build(m_activeX.data(), m_activeY.data(), count);
+    }
+    constexpr int blockSize = 128;
+    m_forcePool.forBlocks(count, blockSize, [&](int begin, int end) {
+        if (useTree) {
+            for (int k = begin; k < end; ++k) {
+                m_repulsionTree.accumulateForce(k, m_params.repulsion, m_params.theta, m_activeFx[k], m_activeFy[k]);
+            }
+        } else {
+            m_kernels.repulse(m_activeX.data(), m_activeY.data(), count, begin, end,
+                              m_params.repulsion, m_activeFx.data(), m_activeFy.data());
+        }
+        for (int k = begin; k < end; ++k) {
+            m_frozenTree.accumulateForceAt(m_activeX[k], m_activeY[k], m_params.repulsion, m_params.theta,
+                                           m_activeFx[k], m_activeFy[k]);
+            vx[m_activeNodes[k]] += m_activeFx[k];
+            vy[m_activeNodes[k]] += m_activeFy[k];
+        }
+    });
+
+    // Springs touching an active node; frozen endpoints do not move.
+    for (int e : m_activeEdges) {
+        const int a = m_store.edgeA[e], b = m_store.edgeB[e];
+        const double dx = x[a] - x[b];
+        const double dy = y[a] - y[b];
+        const double dist = std::max(1e-6, std::sqrt(dx * dx + dy * dy));
+        const double force = m_params.springStrength * (dist - m_params.springLength) / dist;
+        if (m_isActive[a]) {
+            vx[a] -= dx * force;
+            vy[a] -= dy * force;
+        }
+        if (m_isActive[b]) {
+            vx[b] += dx * force;
+            vy[b] += dy * force;
+        }
+    }
+
+    // Gravity, cap, integrate; motion is measured here since frozen nodes
+    // do not move.
+    savePinned();
+    double energy = 0.0;
+    double maxDisp2 = 0.0;
+    for (int i : m_activeNodes) {
+        applyGravityAndCap(i);
+        x[i] += vx[i];
+        y[i] += vy[i];
+        vx[i] *= m_params.damping;
+        vy[i] *= m_params.damping;
+    }
+    restorePinned();
+    for (int k = 0; k < count; ++k) {
+        const int i = m_activeNodes[k];
+        const double dx = x[i] - m_activeX[k];
+        const double dy = y[i] - m_activeY[k];
+        const double d2 = dx * dx + dy * dy;
+        energy += d2;
+        maxDisp2 = std::max(maxDisp2, d2);
+    }
+    m_kineticEnergy = energy;
+    m_maxDisplacement = std::sqrt(maxDisp2);
+}
+
+void LayoutWorker::markFrameChanged(int i) {
+    if (m_frameAllChanged) return;
+    if (size_t(i) >= m_inFrameChanged.size()) m_inFrameChanged.resize(m_store.size(), 0);
+    if (m_inFrameChanged[i]) return;
+    m_inFrameChanged[i] = 1;
+    m_frameChanged.push_back(i);
+}
+
+void LayoutWorker::publishFrame() {
+    // Edge changes alone are chained as deltas until they add up to a good
+    // part of the edges; then a new topology is cheaper for the renderer.
+    const int maxDeltaSize = std::max(256, m_store.edgeCount() / 4);
+    if (m_republishTopology || !m_topology || m_edgeDeltaSize + int(m_edgeChanges.size()) > maxDeltaSize) {
+        auto topology = std::make_shared<LayoutTopology>();
+        topology->ids = m_store.ids;
+        topology->names = m_store.names;
+        topology->edgeA = m_store.edgeA;
+        topology->edgeB = m_store.edgeB;
+        topology->edgeWeight = m_store.edgeWeight;
+        m_topology = std::move(topology);
+        m_edgeDelta.reset();
+        m_edgeDeltaSize = 0;
+        m_edgeChanges.clear();
+        m_republishTopology = false;
+    } else if (!m_edgeChanges.empty()) {
+        auto delta = std::make_shared<LayoutEdgeDelta>();
+        delta->version = m_edgeDelta ? m_edgeDelta->version + 1 : 1;
+        delta->changes.swap(m_edgeChanges);
+        delta->previous = std::move(m_edgeDelta);
+        m_edgeDeltaSize += int(delta->changes.size());
+        m_edgeDelta = std::move(delta);
+    }
+    m_topologyDirty = false;
+
+    // The back buffer last held frame 'frame.serial'. Unless a frame since
+    // then changed every node, only the nodes changed since are copied.
+    LayoutFrame& frame = m_frames.back();
+    const quint64 serial = ++m_frameSerial;
+    PublishedChanges& published = m_published[serial % m_published.size()];
+    published.serial = serial;
+    published.all = m_frameAllChanged;
+    published.nodes.assign(m_frameChanged.begin(), m_frameChanged.end());
+
+    const size_t n = m_store.x.size();
+    bool copyAll = frame.x.size() != n || frame.serial == 0 || serial - frame.serial > m_published.size();
+    for (quint64 s = frame.serial + 1; s <= serial && !copyAll; ++s) {
+        const PublishedChanges& changes = m_published[s % m_published.size()];
+        copyAll = changes.serial != s || changes.all;
+    }
+    if (copyAll) {
+        frame.x.assign(m_store.x.begin(), m_store.x.end());
+        frame.y.assign(m_store.y.begin(), m_store.y.end());
+        frame.fromX.assign(m_prevX.begin(), m_prevX.end());
+        frame.fromY.assign(m_prevY.begin(), m_prevY.end());
+    } else {
+        for (quint64 s = frame.serial + 1; s <= serial; ++s) {
+            for (int i : m_published[s % m_published.size()].nodes) {
+                frame.x[i] = m_store.x[i];
+                frame.y[i] = m_store.y[i];
+                frame.fromX[i] = m_prevX[i];
+                frame.fromY[i] = m_prevY[i];
+            }
+        }
+    }
+    frame.topology = m_topology;
+    frame.edgeDelta = m_edgeDelta;
+    frame.serial = serial;
+    frame.allChanged = m_frameAllChanged;
+    if (m_frameAllChanged) {
+        frame.changed.clear();
+    } else {
+        frame.changed.assign(m_frameChanged.begin(), m_frameChanged.end());
+    }
+    for (int i : m_frameChanged) m_inFrameChanged[i] = 0;
+    m_frameChanged.clear();
+    m_frameAllChanged = false;
+    frame.stepTime = m_stepTime;
+    frame.stepInterval = qint64(m_params.stepInterval) * 1000000;
+    frame.kineticEnergy = m_kineticEnergy;
+    frame.maxDisplacement = m_maxDisplacement;
+    frame.sleeping = m_sleeping;
+    m_frames.publish();
+
+    emit frameReady();
+}
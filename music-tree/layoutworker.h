@@ -0,0 +1,249 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QObject>
+#include <QMutex>
+#include <QPointF>
+#include <QSet>
+#include <QSizeF>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <variant>
+#include <vector>
+#include "artist.h"
+#include "barneshut.h"
+#include "forcekernels.h"
+#include "forcepool.h"
+#include "layoutengine.h"
+#include "layoutstore.h"
+#include "multilevel.h"
+#include "sessionsnapshot.h"
+#include "spatialgrid.h"
+#include "triplebuffer.h"
+
+// Node keys/names and edges of one topology version. Immutable once
+// published, and shared by every frame until a node or edge changes.
+struct LayoutTopology {
+    QVector<ArtistKey> ids;
+    QVector<QString> names;
+    std::vector<int> edgeA, edgeB;
+    std::vector<double> edgeWeight;
+};
+
+// One change to LayoutStore's edge arrays. Replayed in order on a copy of
+// the arrays, the changes give the store's: Added appends edge a-b, and
+// Removed swap-removes like the store, so the last edge moves to 'edge'.
+struct LayoutEdgeChange {
+    enum Kind : quint8 { Added, Removed };
+    Kind kind;
+    int edge;
+    int a = -1, b = -1;   // Added only
+    double weight = 0.0;  // Added only
+};
+
+// The edge changes published with one frame, chained to the earlier ones
+// back to the frame's topology, so a renderer that skipped frames still
+// finds every change it has not applied. Immutable once published.
+struct LayoutEdgeDelta {
+    quint64 version = 1;  // 1 for the first delta after a topology, counting up
+    std::vector<LayoutEdgeChange> changes;
+    std::shared_ptr<const LayoutEdgeDelta> previous;
+};
+
+// One finished simulation step as seen by the renderer.
+// x/y are indexed like topology->ids.
+struct LayoutFrame {
+    std::vector<double> x, y;
+    std::shared_ptr<const LayoutTopology> topology;
+    // Edges added and removed since topology was published, null if none.
+    // Node changes publish a new topology instead.
+    std::shared_ptr<const LayoutEdgeDelta> edgeDelta;
+
+    // Positions one step earlier; nodes moved by a command since (dragged,
+    // added) are already at x/y here. x/y are due at stepTime on
+    // LayoutWorker::clockNs(), so a renderer blends from fromX/Y to x/y
+    // over the step interval that follows.
+    std::vector<double> fromX, fromY;
+    qint64 stepTime = 0;
+    qint64 stepInterval = 1; // ns
+
+    // How far to blend from fromX/Y (0) to x/y (1) when drawing at time.
+    double blendAt(qint64 time) const {
+        return std::clamp(double(time - stepTime) / double(stepInterval), 0.0, 1.0);
+    }
+
+    // Frames are numbered as published. changed lists the nodes whose
+    // x/y or fromX/Y may differ from frame serial - 1, unless allChanged
+    // (topology changes, full steps); a renderer that skipped a frame
+    // rereads every node.
+    quint64 serial = 0;
+    std::vector<int> changed;
+    bool allChanged = true;
+
+    double kineticEnergy = 0.0;   // sum of squared displacements in the last tick
+    double maxDisplacement = 0.0;
+    bool sleeping = false;        // no further frames until a command wakes the simulation
+};
+
+// Commands sent from the GUI thread to the simulation.
+// pos is only used if the artist has no placed collaborators, unless it was
+// restored from an earlier layout; such nodes start exactly there.
+struct AddNodeCommand { ArtistKey artist; QString name; QPointF pos; bool restored = false; };
+struct RemoveNodeCommand { ArtistKey artist; };
+// Applied edge by edge; if a delta was missed (or this is the first one)
+// the edges are rebuilt from the session snapshot instead.
+struct UpdateEdgesCommand { CollabDelta delta; SessionSnapshotPtr session; };
+struct MoveNodesCommand { QVector<ArtistKey> artists; QVector<QPointF> positions; }; // pins the nodes while dragged
+struct ReleaseNodesCommand { QVector<ArtistKey> artists; };
+struct SetBoundsCommand { QSizeF size; };                  // the world is unbounded; a resize only wakes the simulation
+struct SetParamsCommand { LayoutParams params; };
+struct RelayoutCommand {};                                 // multilevel layout of the whole graph
+struct ClearCommand {};                                    // drops every node and edge; the session was cleared
+
+using LayoutCommand = std::variant<AddNodeCommand, RemoveNodeCommand, UpdateEdgesCommand,
+                                   MoveNodesCommand, ReleaseNodesCommand,
+                                   SetBoundsCommand, SetParamsCommand, RelayoutCommand, ClearCommand>;
+
+
+// Runs the force simulation on its own thread.
+// The GUI thread only post()s commands and reads finished frames through a
+// triple buffer, so a slow tick never blocks input handling or painting.
+// Once the graph is at rest the tick timer stops and no frames are
+// published; any posted command wakes it up again.
+//
+// Simulated time advances in fixed steps of LayoutParams::stepInterval: each
+// tick runs as many steps as the wall clock has accumulated, so a late timer
+// costs smoothness of the steps, not speed of the layout. The renderer
+// hides the step rate by blending between the last two states.
+class LayoutWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit LayoutWorker(QObject* parent = nullptr);
+
+    // Thread-safe; may be called from any thread.
+    void post(LayoutCommand command);
+
+    // Monotonic clock of LayoutFrame::stepTime, in ns. Thread-safe.
+    qint64 clockNs() const { return m_clock.nsecsElapsed(); }
+
+    // Consumer side of the frame buffer, GUI thread only.
+    bool acquireFrame() { return m_frames.acquire(); }
+    const LayoutFrame& frame() const { return m_frames.front(); }
+
+public slots:
+    void start();
+
+signals:
+    // Emitted from the layout thread after each published frame.
+    void frameReady();
+
+private slots:
+    void tick();
+    void flushCommands();
+
+private:
+    bool applyCommands();
+    void apply(const LayoutCommand& command);
+    void clear();
+    void applyEdgeDelta(const CollabDelta& delta);
+    void resyncEdges(const SessionCollaborations& collabs);
+    void markEdgeChanged(CollabKey key);
+    void simulate();
+    void step();
+    void stepActive();
+    void updateActiveSet(bool wasSleeping);
+    void buildActiveSet();
+    void applyGravityAndCap(int i);
+    void savePinned();
+    void restorePinned();
+    void placeNewNodes();
+    void notePlaced(QPointF pos);
+    QPointF openSpaceNear(QPointF pos) const;
+    bool wantsMultilevel() const;
+    void runMultilevel();
+    void measureMotion();
+    void sleep();
+    void wake();
+    void resolveDragged();
+    void markFrameChanged(int i);
+    void publishFrame();
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastTick = 0;       // m_clock time of the previous tick
+    qint64 m_accumulated = 0;    // wall time not yet simulated, ns
+    qint64 m_stepTime = 0;       // m_clock time the current state is due at
+    const ForceKernels::KernelTable& m_kernels;
+
+    QMutex m_commandMutex;
+    std::vector<LayoutCommand> m_pending; // guarded by m_commandMutex
+    std::atomic<bool> m_flushQueued{false};
+
+    // Simulation state, layout thread only.
+    LayoutStore m_store;
+    ForcePool m_forcePool;
+    std::unique_ptr<LayoutEngine> m_engine;    // steps the whole graph
+    BarnesHutTree m_repulsionTree;             // active-set steps only
+    MultilevelLayout m_multilevel;
+    int m_unplacedNodes = 0;           // added since the last multilevel layout
+    bool m_relayoutRequested = false;
+    bool m_restartEngine = true;       // params changed or a relayout was asked for since the last restart
+    QVector<ArtistKey> m_awaitingPlacement;  // added, placed once their edges are known
+    QSet<ArtistKey> m_restoredIds;           // added at a saved position; edges among them are not changes
+    quint64 m_edgesGeneration = 0;           // session generation the edges are up to date with
+
+    // Active-set mode, see LayoutParams::activeHops.
+    bool m_activeMode = false;
+    bool m_fullChange = false;             // a command affecting the whole graph was applied
+    QSet<ArtistKey> m_changedIds;            // nodes touched by commands since the last active set
+    std::vector<int> m_activeNodes;
+    std::vector<char> m_isActive;          // per node
+    std::vector<int> m_activeEdges;        // edges with at least one active endpoint
+    std::vector<double> m_activeX, m_activeY, m_activeFx, m_activeFy;
+    std::vector<double> m_frozenX, m_frozenY;
+    BarnesHutTree m_frozenTree;            // frozen nodes only; built once per active set
+    bool m_prevFrozenCurrent = false;      // m_prevX/Y already match the store for frozen nodes
+    // The open space search looks at a snapshot of the positions, kept
+    // until the simulation steps or a node is dragged; nodes placed since
+    // are in m_placedSinceGrid, up to maxPlacedSinceGrid of them.
+    static constexpr size_t maxPlacedSinceGrid = 64;
+    SpatialGrid m_placementGrid;           // over m_placementX/Y
+    std::vector<double> m_placementX, m_placementY;
+    bool m_placementGridValid = false;
+    std::vector<QPointF> m_placedSinceGrid;
+    std::vector<int> m_placementSlot;      // per node, scratch for placeNewNodes()
+    LayoutParams m_params;
+    QSet<ArtistKey> m_draggedIds;
+    std::vector<int> m_dragged;          // store indices of m_draggedIds
+    std::vector<QPointF> m_draggedPos;   // scratch for pinning during integrate
+    bool m_topologyDirty = true;         // nodes or edges changed since the last frame
+    bool m_republishTopology = true;     // node indices changed, or the edges were rebuilt
+    std::vector<LayoutEdgeChange> m_edgeChanges; // since the last frame, see LayoutFrame::edgeDelta
+    std::shared_ptr<const LayoutEdgeDelta> m_edgeDelta;
+    int m_edgeDeltaSize = 0;             // changes chained since m_topology
+    bool m_sleeping = false;
+    int m_restTicks = 0;
+    double m_kineticEnergy = 0.0;
+    double m_maxDisplacement = 0.0;
+    std::vector<double> m_prevX, m_prevY; // positions before the last step, what frames blend from
+    // Nodes changed since the last published frame, see LayoutFrame::changed.
+    std::vector<int> m_frameChanged;
+    std::vector<char> m_inFrameChanged;    // per node
+    bool m_frameAllChanged = true;
+    quint64 m_frameSerial = 0;
+    // What the last few frames changed, by serial modulo the size. A reused
+    // back buffer is brought up to date from these instead of copied whole.
+    struct PublishedChanges {
+        quint64 serial = 0;
+        bool all = true;
+        std::vector<int> nodes;
+    };
+    std::array<PublishedChanges, 4> m_published;
+    std::shared_ptr<const LayoutTopology> m_topology;
+
+    TripleBuffer<LayoutFrame> m_frames;
+};
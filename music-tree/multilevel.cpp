@@ -0,0 +1,257 @@
+#include "multilevel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+// Levels below this size use the exact pairwise repulsion.
+constexpr int exactRepulsionLimit = 64;
+
+// Coarsening stops once a pass keeps more than this share of the nodes.
+constexpr double minShrink = 0.85;
+
+// Natural spring length between two merged nodes: their members occupy an
+// area proportional to their mass, so the length grows with sqrt(mass).
+double levelSpringLength(double length, double massA, double massB) {
+    return length * (std::sqrt(massA) + std::sqrt(massB)) / 2.0;
+}
+
+} // namespace
+
+void MultilevelLayout::run(std::vector<double>& x, std::vector<double>& y,
+                           const std::vector<int>& edgeA, const std::vector<int>& edgeB,
+                           const std::vector<double>& edgeWeight, const Options& options) {
+    const int n = int(x.size());
+    m_levels.clear();
+    if (n == 0) return;
+
+    Level finest;
+    finest.size = n;
+    finest.mass.assign(n, 1.0);
+    finest.edgeA = edgeA;
+    finest.edgeB = edgeB;
+    finest.edgeWeight = edgeWeight.empty() ? std::vector<double>(edgeA.size(), 1.0) : edgeWeight;
+    finest.edgeCount.assign(edgeA.size(), 1.0);
+    m_levels.push_back(std::move(finest));
+
+    while (m_levels.back().size > options.coarsestSize && coarsen(int(m_levels.size()) - 1)) {
+    }
+
+    // Coarsest level: random start in a disc sized for its total mass.
+    std::mt19937 rng(options.seed);
+    Level& coarsest = m_levels.back();
+    {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        const double radius = options.springLength * std::sqrt(double(n));
+        coarsest.x.resize(coarsest.size);
+        coarsest.y.resize(coarsest.size);
+        for (int i = 0; i < coarsest.size; ++i) {
+            const double r = radius * std::sqrt(unit(rng));
+            const double a = 2.0 * pi * unit(rng);
+            coarsest.x[i] = r * std::cos(a);
+            coarsest.y[i] = r * std::sin(a);
+        }
+    }
+    relax(coarsest, options.coarsestIterations, options);
+
+    // Prolong each level onto the next finer one and refine it there.
+    for (int l = int(m_levels.size()) - 2; l >= 0; --l) {
+        Level& fine = m_levels[l];
+        const Level& coarse = m_levels[l + 1];
+        std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+        fine.x.resize(fine.size);
+        fine.y.resize(fine.size);
+        for (int i = 0; i < fine.size; ++i) {
+            const int p = fine.parent[i];
+            const double spread = options.springLength * std::sqrt(coarse.mass[p]) * 0.25;
+            fine.x[i] = coarse.x[p] + jitter(rng) * spread;
+            fine.y[i] = coarse.y[p] + jitter(rng) * spread;
+        }
+        relax(fine, options.refineIterations, options);
+    }
+
+    x = std::move(m_levels.front().x);
+    y = std::move(m_levels.front().y);
+    m_levels.front().x.clear();
+    m_levels.front().y.clear();
+}
+
+bool MultilevelLayout::coarsen(int index) {
+    Level& fine = m_levels[index];
+    const int n = fine.size;
+    const int edgeCount = int(fine.edgeA.size());
+
+    // CSR adjacency of the fine level.
+    std::vector<int> start(n + 1, 0);
+    for (int e = 0; e < edgeCount; ++e) {
+        ++start[fine.edgeA[e] + 1];
+        ++start[fine.edgeB[e] + 1];
+    }
+    std::partial_sum(start.begin(), start.end(), start.begin());
+    std::vector<int> adjacent(start[n]);
+    std::vector<double> adjacentWeight(start[n]);
+    {
+        std::vector<int> fill(start.begin(), start.end() - 1);
+        for (int e = 0; e < edgeCount; ++e) {
+            const int a = fine.edgeA[e], b = fine.edgeB[e];
+            adjacent[fill[a]] = b;
+            adjacentWeight[fill[a]++] = fine.edgeWeight[e];
+            adjacent[fill[b]] = a;
+            adjacentWeight[fill[b]++] = fine.edgeWeight[e];
+        }
+    }
+
+    // Heavy-edge matching, lightest nodes first so clusters stay balanced.
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return fine.mass[a] < fine.mass[b]; });
+
+    double totalMass = 0.0;
+    for (double m : fine.mass) totalMass += m;
+    const double massCap = 4.0 * totalMass / n;
+
+    std::vector<int> parent(n, -1);
+    std::vector<double> coarseMass;
+    coarseMass.reserve(n);
+    for (int u : order) {
+        if (parent[u] >= 0) continue;
+        int best = -1;
+        double bestWeight = 0.0;
+        for (int k = start[u]; k < start[u + 1]; ++k) {
+            const int v = adjacent[k];
+            if (v != u && parent[v] < 0 && adjacentWeight[k] > bestWeight) {
+                best = v;
+                bestWeight = adjacentWeight[k];
+            }
+        }
+        if (best >= 0) {
+            parent[u] = parent[best] = int(coarseMass.size());
+            coarseMass.push_back(fine.mass[u] + fine.mass[best]);
+            continue;
+        }
+
+        // All neighbours are taken (typical for the leaves of a hub): join
+        // the heaviest neighbouring group unless it is already large.
+        int group = -1;
+        bestWeight = 0.0;
+        for (int k = start[u]; k < start[u + 1]; ++k) {
+            const int g = parent[adjacent[k]];
+            if (g >= 0 && coarseMass[g] + fine.mass[u] <= massCap && adjacentWeight[k] > bestWeight) {
+                group = g;
+                bestWeight = adjacentWeight[k];
+            }
+        }
+        if (group >= 0) {
+            parent[u] = group;
+            coarseMass[group] += fine.mass[u];
+        } else {
+            parent[u] = int(coarseMass.size());
+            coarseMass.push_back(fine.mass[u]);
+        }
+    }
+
+    const int coarseSize = int(coarseMass.size());
+    if (coarseSize > minShrink * n) return false;
+
+    // Merge parallel edges, summing their weights; edges inside a group vanish.
+    std::vector<std::pair<std::uint64_t, int>> merged; // (coarse endpoints, fine edge)
+    merged.reserve(edgeCount);
+    for (int e = 0; e < edgeCount; ++e) {
+        int a = parent[fine.edgeA[e]], b = parent[fine.edgeB[e]];
+        if (a == b) continue;
+        if (a > b) std::swap(a, b);
+        merged.emplace_back((std::uint64_t(a) << 32) | std::uint32_t(b), e);
+    }
+    std::sort(merged.begin(), merged.end(),
+              [](const auto& l, const auto& r) { return l.first < r.first; });
+
+    Level coarse;
+    coarse.size = coarseSize;
+    coarse.mass = std::move(coarseMass);
+    for (size_t k = 0; k < merged.size(); ++k) {
+        const int e = merged[k].second;
+        if (k > 0 && merged[k].first == merged[k - 1].first) {
+            coarse.edgeWeight.back() += fine.edgeWeight[e];
+            coarse.edgeCount.back() += fine.edgeCount[e];
+            continue;
+        }
+        coarse.edgeA.push_back(int(merged[k].first >> 32));
+        coarse.edgeB.push_back(int(merged[k].first & 0xffffffffu));
+        coarse.edgeWeight.push_back(fine.edgeWeight[e]);
+        coarse.edgeCount.push_back(fine.edgeCount[e]);
+    }
+
+    fine.parent = std::move(parent);
+    m_levels.push_back(std::move(coarse));
+    return true;
+}
+
+void MultilevelLayout::relax(Level& level, int iterations, const Options& options) {
+    const int n = level.size;
+    double* x = level.x.data();
+    double* y = level.y.data();
+    const double* mass = level.mass.data();
+    m_vx.assign(n, 0.0);
+    m_vy.assign(n, 0.0);
+
+    // The step limit cools linearly, so early iterations may move nodes far
+    // and the last ones only settle them.
+    const double startStep = options.springLength * 2.0;
+    const double endStep = options.springLength * 0.05;
+
+    for (int it = 0; it < iterations; ++it) {
+        m_fx.assign(n, 0.0);
+        m_fy.assign(n, 0.0);
+
+        // Repulsion: strength / dist^2 per unit of source mass, so a merged
+        // node pushes like the nodes it stands for.
+        if (n > exactRepulsionLimit) {
+            m_tree.build(x, y, n, mass);
+            for (int i = 0; i < n; ++i) {
+                m_tree.accumulateForce(i, options.repulsion, options.theta, m_fx[i], m_fy[i]);
+            }
+        } else {
+            for (int i = 0; i < n; ++i) {
+                for (int j = 0; j < n; ++j) {
+                    if (i == j) continue;
+                    const double dx = x[i] - x[j];
+                    const double dy = y[i] - y[j];
+                    const double dist = std::max(1.0, std::sqrt(dx * dx + dy * dy));
+                    const double force = mass[j] * options.repulsion / (dist * dist * dist);
+                    m_fx[i] += dx * force;
+                    m_fy[i] += dy * force;
+                }
+            }
+        }
+
+        // Springs, weighted by how many fine edges the coarse edge stands for
+        // and split between the endpoints by mass.
+        for (size_t e = 0; e < level.edgeA.size(); ++e) {
+            const int a = level.edgeA[e], b = level.edgeB[e];
+            const double dx = x[a] - x[b];
+            const double dy = y[a] - y[b];
+            const double dist = std::max(1e-6, std::sqrt(dx * dx + dy * dy));
+            const double length = levelSpringLength(options.springLength, mass[a], mass[b]);
+            const double force = options.springStrength * level.edgeCount[e] * (dist - length) / dist;
+            m_fx[a] -= dx * force / mass[a];
+            m_fy[a] -= dy * force / mass[a];
+            m_fx[b] += dx * force / mass[b];
+            m_fy[b] += dy * force / mass[b];
+        }
+
+        const double maxStep = startStep + (endStep - startStep) * it / std::max(1, iterations - 1);
+        for (int i = 0; i < n; ++i) {
+            m_vx[i] = (m_vx[i] + m_fx[i] - options.gravity * x[i]) * options.damping;
+            m_vy[i] = (m_vy[i] + m_fy[i] - options.gravity * y[i]) * options.damping;
+            const double step = std::sqrt(m_vx[i] * m_vx[i] + m_vy[i] * m_vy[i]);
+            const double limit = step > maxStep ? maxStep / step : 1.0;
+            x[i] += m_vx[i] * limit;
+            y[i] += m_vy[i] * limit;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include "barneshut.h"
+
+// Multilevel force layout (coarsen - lay out - refine) for placing a large,
+// mostly unplaced graph in one go.
+//
+// The graph is repeatedly coarsened by heavy-edge matching: every node is
+// merged with the unmatched neighbour it shares the most releases with, and
+// the merged node carries the mass of its members. The coarsest graph (a few
+// dozen nodes) is laid out from scratch; each finer level starts from its
+// parent's position and only needs a short refinement, because the global
+// shape is already right. Every level is about half the size of the one
+// below, so the total work stays close to linear in the graph size.
+//
+// The force model matches LayoutWorker's, so the result is close to the
+// simulation's own rest state and it only has to polish it.
+class MultilevelLayout {
+public:
+    struct Options {
+        double repulsion = 2000.0;
+        double springLength = 100.0;
+        double springStrength = 0.01;
+        double gravity = 0.0005;
+        double damping = 0.85;
+        double theta = 0.8;
+        int coarsestSize = 50;         // stop coarsening at this many nodes
+        int coarsestIterations = 300;
+        int refineIterations = 30;     // per finer level
+        unsigned seed = 1;
+    };
+
+    // Lays out n nodes connected by the given edges, overwriting x/y.
+    // edgeWeight may be empty (every edge weighs 1).
+    void run(std::vector<double>& x, std::vector<double>& y,
+             const std::vector<int>& edgeA, const std::vector<int>& edgeB,
+             const std::vector<double>& edgeWeight, const Options& options);
+
+    int levelCount() const { return int(m_levels.size()); }
+
+private:
+    struct Level {
+        int size = 0;
+        std::vector<double> mass;
+        std::vector<int> edgeA, edgeB;
+        std::vector<double> edgeWeight; // shared releases, drives the matching
+        std::vector<double> edgeCount;  // fine edges merged into this one, scales the spring
+        std::vector<int> parent; // node of the next coarser level, empty on the coarsest
+        std::vector<double> x, y;
+    };
+
+    // Builds m_levels[index + 1] from m_levels[index]; false if it would
+    // barely shrink the graph.
+    bool coarsen(int index);
+    void relax(Level& level, int iterations, const Options& options);
+
+    std::vector<Level> m_levels;
+    BarnesHutTree m_tree;
+    std::vector<double> m_fx, m_fy;
+    std::vector<double> m_vx, m_vy;
+};
@@ -0,0 +1,171 @@
+#pragma once
+#include <QtAlgorithms>
+#include <QtGlobal>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// A map whose copies share structure: a hash array mapped trie over the
+// 64-bit key bits, 32 ways per level. insert() and remove() copy only the
+// path to the changed entry (O(log32 n) small nodes) and leave every other
+// node shared with older copies, so copying the map is O(1) and a copy
+// taken before a change keeps seeing the old contents. Copies may be read
+// from any thread; each copy is only modified by its owner.
+//
+// KeyBits must map keys to 64 bits injectively (no two keys the same
+// bits); the bits are scrambled with a bijective mix, so there are no
+// collisions to resolve.
+template <typename K, typename V, typename KeyBits>
+class PersistentMap {
+public:
+    const V* find(const K& key) const {
+        const quint64 bits = mix(KeyBits()(key));
+        const Node* node = m_root.get();
+        for (int shift = 0; node; shift += bitsPerLevel) {
+            const quint32 bit = 1u << ((bits >> shift) & levelMask);
+            if (!(node->bitmap & bit)) return nullptr;
+            const Slot& slot = node->entries[slotIndex(node->bitmap, bit)];
+            if (auto* leaf = std::get_if<Leaf>(&slot)) {
+                return leaf->first == key ? &leaf->second : nullptr;
+            }
+            node = std::get<NodePtr>(slot).get();
+        }
+        return nullptr;
+    }
+    bool contains(const K& key) const { return find(key) != nullptr; }
+
+    // Inserts or replaces.
+    void insert(const K& key, V value) {
+        bool added = false;
+        m_root = insertAt(m_root.get(), Leaf(key, std::move(value)), mix(KeyBits()(key)), 0, added);
+        if (added) ++m_size;
+    }
+
+    // Returns false if the key was not present.
+    bool remove(const K& key) {
+        if (!m_root) return false;
+        bool removed = false;
+        NodePtr root = removeAt(*m_root, key, mix(KeyBits()(key)), 0, removed);
+        if (!removed) return false;
+        m_root = std::move(root);
+        --m_size;
+        return true;
+    }
+
+    void clear() {
+        m_root.reset();
+        m_size = 0;
+    }
+
+    qsizetype size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    // Calls fn(key, value) for every entry, in no particular order.
+    template <typename Fn>
+    void forEach(const Fn& fn) const {
+        if (m_root) forEachIn(*m_root, fn);
+    }
+
+private:
+    static constexpr int bitsPerLevel = 5;
+    static constexpr quint64 levelMask = 31;
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+    using Leaf = std::pair<K, V>;
+    using Slot = std::variant<Leaf, NodePtr>;
+
+    // Only the slots whose bit is set are stored, in bit order.
+    struct Node {
+        quint32 bitmap = 0;
+        std::vector<Slot> entries;
+    };
+
+    // splitmix64's finalizer; bijective, so distinct keys keep distinct bits.
+    static quint64 mix(quint64 x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    static int slotIndex(quint32 bitmap, quint32 bit) { return int(qPopulationCount(bitmap & (bit - 1))); }
+
+    static NodePtr insertAt(const Node* node, Leaf&& leaf, quint64 bits, int shift, bool& added) {
+        const quint32 bit = 1u << ((bits >> shift) & levelMask);
+        auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+        const int index = slotIndex(copy->bitmap, bit);
+
+        if (!(copy->bitmap & bit)) {
+            copy->entries.insert(copy->entries.begin() + index, Slot(std::move(leaf)));
+            copy->bitmap |= bit;
+            added = true;
+        } else if (auto* existing = std::get_if<Leaf>(&copy->entries[index])) {
+            if (existing->first == leaf.first) {
+                existing->second = std::move(leaf.second);
+            } else {
+                // Two keys share this slot: push both one level down.
+                Leaf other = std::move(*existing);
+                const quint64 otherBits = mix(KeyBits()(other.first));
+                NodePtr child = insertAt(nullptr, std::move(other), otherBits, shift + bitsPerLevel, added);
+                child = insertAt(child.get(), std::move(leaf), bits, shift + bitsPerLevel, added);
+                copy->entries[index] = std::move(child);
+            }
+        } else {
+            const Node* child = std::get<NodePtr>(copy->entries[index]).get();
+            copy->entries[index] = insertAt(child, std::move(leaf), bits, shift + bitsPerLevel, added);
+        }
+        return copy;
+    }
+
+    // Returns the replacement for node: null once it is empty. A child left
+    // with a single leaf is folded into its parent.
+    static NodePtr removeAt(const Node& node, const K& key, quint64 bits, int shift, bool& removed) {
+        const quint32 bit = 1u << ((bits >> shift) & levelMask);
+        if (!(node.bitmap & bit)) return nullptr;
+        const int index = slotIndex(node.bitmap, bit);
+        const Slot& slot = node.entries[index];
+
+        std::optional<Slot> replacement; // unset: drop the slot
+        if (auto* leaf = std::get_if<Leaf>(&slot)) {
+            if (!(leaf->first == key)) return nullptr;
+        } else {
+            NodePtr child = removeAt(*std::get<NodePtr>(slot), key, bits, shift + bitsPerLevel, removed);
+            if (!removed) return nullptr;
+            if (child && child->entries.size() == 1 && std::holds_alternative<Leaf>(child->entries.front())) {
+                replacement = child->entries.front();
+            } else if (child) {
+                replacement = std::move(child);
+            }
+        }
+        removed = true;
+
+        auto copy = std::make_shared<Node>(node);
+        if (!replacement) {
+            copy->entries.erase(copy->entries.begin() + index);
+            copy->bitmap &= ~bit;
+            if (copy->entries.empty()) return nullptr;
+        } else {
+            copy->entries[index] = std::move(*replacement);
+        }
+        return copy;
+    }
+
+    template <typename Fn>
+    static void forEachIn(const Node& node, const Fn& fn) {
+        for (const Slot& slot : node.entries) {
+            if (auto* leaf = std::get_if<Leaf>(&slot)) {
+                fn(leaf->first, leaf->second);
+            } else {
+                forEachIn(*std::get<NodePtr>(slot), fn);
+            }
+        }
+    }
+
+    NodePtr m_root;
+    qsizetype m_size = 0;
+};
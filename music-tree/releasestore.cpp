@@ -0,0 +1,30 @@
+#include "releasestore.h"
+
+ReleaseKey ReleaseStore::intern(const ReleaseInfo& release) {
+    const ReleaseKey key = m_ids.intern(release.id);
+    if (key >= m_summaries.size()) {
+        m_summaries.resize(key + 1);
+        m_isHeld.resize(key + 1, 0);
+    }
+    if (!m_isHeld[key]) {
+        m_summaries[key] = Summary{release.title, release.year};
+        m_isHeld[key] = 1;
+        ++m_held;
+    }
+    return key;
+}
+
+void ReleaseStore::release(ReleaseKey key) {
+    if (key >= m_isHeld.size() || !m_isHeld[key]) return;
+    m_summaries[key] = Summary();
+    m_isHeld[key] = 0;
+    --m_held;
+}
+
+qsizetype ReleaseStore::memoryEstimate() const {
+    qsizetype bytes = qsizetype(m_summaries.capacity() * sizeof(Summary) + m_isHeld.capacity());
+    for (const Summary& summary : m_summaries) {
+        bytes += stringHeapBytes(summary.title);
+    }
+    return bytes + m_ids.memoryEstimate();
+}
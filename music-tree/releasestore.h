@@ -0,0 +1,39 @@
+#pragma once
+#include <QString>
+#include <vector>
+#include "artist.h"
+#include "idtable.h"
+
+// The releases of the session, each stored once however many session
+// artists share it, under its interned ReleaseKey. Only what the session
+// needs at a glance is kept (title, year); the rest of a release (country,
+// genre, URLs, data quality, the artist's role) stays in the DB and is read
+// from there when the UI asks for it, see ArtistService::releaseDetails().
+// Like IdTable, GUI thread only.
+class ReleaseStore {
+public:
+    struct Summary {
+        QString title;
+        int year = 0;
+    };
+
+    // The release's key; its summary is stored if it was not held yet.
+    ReleaseKey intern(const ReleaseInfo& release);
+    // Frees the summary once no session artist refers to the release. The
+    // key stays assigned to the id.
+    void release(ReleaseKey key);
+
+    ReleaseKey find(const QString& id) const { return m_ids.find(id); }
+    const QString& id(ReleaseKey key) const { return m_ids.toString(key); }
+    const Summary& summary(ReleaseKey key) const { return m_summaries[key]; }
+    int size() const { return m_held; }
+
+    // Rough heap use in bytes, ids included.
+    qsizetype memoryEstimate() const;
+
+private:
+    IdTable m_ids;
+    std::vector<Summary> m_summaries; // by ReleaseKey, empty title when not held
+    std::vector<char> m_isHeld;       // by ReleaseKey
+    int m_held = 0;
+};
@@ -1,3 +1,7 @@
+-- Schema version 1, stored in PRAGMA user_version. Databases created from an
+-- older version are upgraded by DatabaseManager::migrateSchema(); a change here
+-- needs a step there and a new schemaVersion.
+
 -- Artists table
 CREATE TABLE IF NOT EXISTS artists (
     id TEXT PRIMARY KEY,      -- Discogs artist ID (string)
@@ -7,7 +11,7 @@ CREATE TABLE IF NOT EXISTS artists (
     resource_url TEXT
 );
 
-CREATE TABLE Members (
+CREATE TABLE IF NOT EXISTS Members (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
     artist_id INTEGER NOT NULL,   -- The band/group artist ID
     member_id INTEGER,            -- Discogs ID of the member
@@ -65,6 +69,13 @@ CREATE TABLE IF NOT EXISTS release_labels (
     FOREIGN KEY (label_id) REFERENCES labels(id) ON DELETE CASCADE
 );
 
+-- Last layout position of each artist, restored when the artist is added again
+CREATE TABLE IF NOT EXISTS layout_positions (
+    artist_id TEXT PRIMARY KEY,
+    x REAL NOT NULL,
+    y REAL NOT NULL
+);
+
 -- Indexes for fast joins
 CREATE INDEX IF NOT EXISTS idx_release_artists_artist ON release_artists(artist_id);
 CREATE INDEX IF NOT EXISTS idx_release_artists_release ON release_artists(release_id);
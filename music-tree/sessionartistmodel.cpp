@@ -5,14 +5,25 @@ SessionArtistModel::SessionArtistModel(ArtistService* artistService, QObject* pa
 
     m_session = (artistService->sessionManager());
 
-    connect(m_session, &SessionManager::artistAdded, this, [=](const Artist&){
-        int newRow = m_session->artists().size() - 1;
-        beginInsertRows(QModelIndex(), newRow, newRow);
+    connect(m_session, &SessionManager::artistsAdded, this, [=](const QVector<ArtistKey>& keys){
+        const int lastRow = m_session->artistCount() - 1;
+        beginInsertRows(QModelIndex(), lastRow - int(keys.size()) + 1, lastRow);
         endInsertRows();
     });
 
+    // The session fills the gap with its last row, so the last row is the
+    // one that goes and the removed artist's row shows the moved one.
+    connect(m_session, &SessionManager::artistAboutToBeRemoved, this, [=](const Artist&, ArtistKey, int row){
+        const int lastRow = m_session->artistCount() - 1;
+        m_refillRow = row < lastRow ? row : -1;
+        beginRemoveRows(QModelIndex(), lastRow, lastRow);
+    });
     connect(m_session, &SessionManager::artistRemoved, this, [=](const Artist&){
-        beginResetModel(); endResetModel(); // simple but works
+        endRemoveRows();
+        if (m_refillRow >= 0) {
+            emit dataChanged(index(m_refillRow), index(m_refillRow));
+            m_refillRow = -1;
+        }
     });
     connect(m_session, &SessionManager::sessionCleared, this, [=](){
         beginResetModel(); endResetModel();
@@ -20,14 +31,14 @@ SessionArtistModel::SessionArtistModel(ArtistService* artistService, QObject* pa
 }
 
 int SessionArtistModel::rowCount(const QModelIndex&) const {
-    return m_session->artists().size();
+    return m_session->artistCount();
 }
 
 QVariant SessionArtistModel::data(const QModelIndex& index, int role) const {
-    if (!index.isValid() || index.row() >= m_session->artists().size())
+    if (!index.isValid() || index.row() >= m_session->artistCount())
         return QVariant();
 
-    const auto& sessionArtist = m_session->artists().at(index.row());
+    const auto& sessionArtist = m_session->artistAt(index.row());
     if (role == ArtistNameRole) return sessionArtist.name;
     if (role == ArtistIdRole) return sessionArtist.id;
     return QVariant();
@@ -26,4 +26,5 @@ public:
 
 private:
     SessionManager* m_session;
+    int m_refillRow = -1; // between artistAboutToBeRemoved and artistRemoved
 };
@@ -1,106 +1,270 @@
 // SessionManager.cpp
 #include "sessionmanager.h"
+#include <QLoggingCategory>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <numeric>
 
 
+Q_LOGGING_CATEGORY(lcSession, "music_tree.session", QtWarningMsg)
+Q_LOGGING_CATEGORY(lcSessionMemory, "music_tree.session.memory", QtWarningMsg)
+
 SessionManager::SessionManager(QObject* parent) : QObject(parent) {
 }
 
 
-const Artist* SessionManager::getArtistById(const QString& artistId) {
-    std::optional<Artist> result;
-    for (const Artist& a : std::as_const(m_artists)) {
-        if (a.id == artistId) {
-            return &a;
+void SessionManager::addArtist(const Artist& artist) {
+    addArtists({artist});
+}
+
+void SessionManager::addArtists(const std::vector<Artist>& artists) {
+    QMutexLocker locker(&sessionMutex);
+
+    // Slots, keys and interned releases. IdTable is not thread-safe, so
+    // this part stays serial.
+    QVector<ArtistKey> added;
+    added.reserve(qsizetype(artists.size()));
+    for (const Artist& artist : artists) {
+        if (containsArtist(artist)) {
+            qCDebug(lcSession) << "Artist already exists:" << artist.name;
+            continue;
+        }
+        const ArtistKey key = m_artistIds.intern(artist.id);
+        if (key >= m_handles.size()) {
+            m_handles.resize(key + 1);
+            m_releaseSets.resize(key + 1);
+            m_adjacency.resize(key + 1);
+            m_rows.resize(key + 1);
         }
+        // Only id and name are kept: releases go to the release store, once
+        // for the session, and profiles, URLs and release details stay in
+        // the DB.
+        Artist stored;
+        stored.id = artist.id;
+        stored.name = artist.name;
+        const ArtistHandle handle = m_artists.insert(std::move(stored));
+        m_handles[key] = handle;
+        m_rows[key] = int(m_order.size());
+        m_order.append(key);
+        m_artistNames.insert(key, artist.name);
+        internArtistReleases(artist, key);
+        added.append(key);
+    }
+    if (added.isEmpty()) return;
+
+    // Below this many artists the thread pool costs more than it saves.
+    constexpr qsizetype parallelBatch = 64;
+    const auto forEach = [&](auto& sequence, const auto& fn) {
+        if (added.size() >= parallelBatch) {
+            QtConcurrent::blockingMap(sequence, fn);
+        } else {
+            std::for_each(sequence.cbegin(), sequence.cend(), fn);
+        }
+    };
+
+    // Each artist only touches its own release set.
+    forEach(added, [this](ArtistKey key) {
+        ReleaseSet& releases = m_releaseSets[key];
+        std::sort(releases.begin(), releases.end());
+        releases.erase(std::unique(releases.begin(), releases.end()), releases.end());
+    });
+    for (ArtistKey key : std::as_const(added)) {
+        registerArtistReleases(key);
     }
-    return nullptr;
-}
 
-bool SessionManager::containsArtist(const Artist& artist) {
-    for (const Artist& a : std::as_const(m_artists)) {
-        if (a.id == artist.id) return true;
+    // Read-only over the session, so the batch can be searched in parallel;
+    // the results are merged in batch order.
+    std::vector<char> inBatch(m_handles.size(), 0);
+    for (ArtistKey key : std::as_const(added)) inBatch[key] = 1;
+    std::vector<NewCollabs> found(size_t(added.size()));
+    QVector<qsizetype> positions(added.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    forEach(positions, [&](qsizetype i) {
+        found[size_t(i)] = findCollabsForNewArtist(std::as_const(added)[i], inBatch);
+    });
+
+    CollabDelta delta;
+    for (qsizetype i = 0; i < added.size(); ++i) {
+        const ArtistKey newKey = added[i];
+        for (auto& [other, shared] : found[size_t(i)]) {
+            qCDebug(lcSession) << "Release match:" << shared.size() << "shared release(s) with artistId:" << m_artistIds.toString(other);
+            const CollabKey key(newKey, other);
+            delta.added.append({key, int(shared.size())});
+            m_collabs.insert(key, std::move(shared));
+            m_adjacency[newKey].append(other);
+            m_adjacency[other].append(newKey);
+        }
     }
-    return false;
+
+    delta.generation = publishSnapshot();
+    // qCDebug skips its arguments, and so the walk, unless enabled.
+    qCDebug(lcSessionMemory) << "Session:" << m_artists.size() << "artists, ~" << memoryEstimate() / 1024 << "KiB";
+    locker.unlock();
+    emit artistsAdded(added);
+    emit collabsChanged(delta);
 }
 
-void SessionManager::addArtist(const Artist& artist) {
+void SessionManager::removeArtistById(const QString& artistId) {
     QMutexLocker locker(&sessionMutex);
-    if (containsArtist(artist)) {
-        qDebug() << "Artist already exists:" << artist.name;
+    const ArtistKey key = keyOf(artistId);
+    const ArtistHandle handle = handleOf(key);
+    const Artist* artist = m_artists.get(handle);
+    if (!artist) {
+        qWarning() << "removeArtistById: id not found:" << artistId;
         return;
     }
+    const int row = m_rows[key];
+    const Artist removed = *artist; // outlives the slot, for the signals
 
-    m_artists.append(artist);
-    registerArtistReleases(artist);
-    updateCollabsForNewArtist(artist);
+    // Emitted unlocked: sessionMutex is not recursive, and slots (the model
+    // begins its row removal here) may call back into the session. They
+    // must only read it, which the assert checks.
+    locker.unlock();
+    emit artistAboutToBeRemoved(removed, key, row);
+    locker.relock();
+    Q_ASSERT_X(m_artists.contains(handle) && m_rows[key] == row, "removeArtistById",
+               "the session changed while artistAboutToBeRemoved was being handled");
+
+    CollabDelta delta;
+    removeCollabsForArtist(key, delta.removed);
+    unregisterArtistReleases(key);
+    m_artists.remove(handle);
+    m_handles[key] = ArtistHandle();
+    const ArtistKey moved = m_order.takeLast();
+    if (moved != key) {
+        m_order[row] = moved;
+        m_rows[moved] = row;
+    }
+    m_artistNames.remove(key);
 
-    emit artistAdded(artist);
+    delta.generation = publishSnapshot();
+    locker.unlock();
+    emit artistRemoved(removed, key);
+    emit collabsChanged(delta);
 }
 
-void SessionManager::removeArtistById(const QString& artistId) {
-    removeCollabsForArtist(artistId);
+quint64 SessionManager::publishSnapshot() {
+    auto snapshot = std::make_shared<SessionSnapshot>();
+    snapshot->generation = m_generation.load(std::memory_order_relaxed) + 1;
+    snapshot->artists = m_artistNames;
+    snapshot->collabs = m_collabs;
 
-    QMutableVectorIterator<Artist> it(m_artists);
-    while (it.hasNext()) {
-        if (it.next().id == artistId) {
-            unregisterArtistReleases(it.value());
-            const Artist removed = it.value();  // snapshot before remove()
-            it.remove();                        // safe; iterator now before the next item
+    const quint64 generation = snapshot->generation;
+    std::atomic_store(&m_snapshot, SessionSnapshotPtr(std::move(snapshot)));
+    m_generation.store(generation, std::memory_order_release);
+    return generation;
+}
 
-            emit artistRemoved(removed);
-            return;
-        }
+void SessionManager::removeCollabsForArtist(ArtistKey key, QVector<CollabKey>& removed) {
+    for (ArtistKey other : std::as_const(m_adjacency[key])) {
+        removed.append(CollabKey(key, other));
+        m_collabs.remove(CollabKey(key, other));
+        m_adjacency[other].removeOne(key);
     }
-
-    qWarning() << "removeArtistById: id not found:" << artistId;
+    m_adjacency[key].clear();
 }
 
-void SessionManager::removeCollabsForArtist(const QString& artistId) {
-    for (auto it = m_collabs.begin(); it != m_collabs.end(); ) {
-        if (it->first.a == artistId || it->first.b == artistId) {
-            it = m_collabs.erase(it);
-        } else {
-            ++it;
-        }
+// Unsorted until addArtists() sorts the batch.
+void SessionManager::internArtistReleases(const Artist& artist, ArtistKey key) {
+    ReleaseSet& releases = m_releaseSets[key];
+    releases.clear();
+    releases.reserve(qsizetype(artist.releases.size()));
+    for (const ReleaseInfo& r : artist.releases) {
+        releases.append(m_releases.intern(r));
     }
 }
 
-void SessionManager::registerArtistReleases(const Artist& artist) {
-    for (const ReleaseInfo& r : artist.releases) {
-        m_releaseToArtists.insert(r.id, artist.id);
+void SessionManager::registerArtistReleases(ArtistKey key) {
+    for (ReleaseKey release : std::as_const(m_releaseSets[key])) {
+        m_releaseToArtists.insert(release, key);
     }
 }
 
-void SessionManager::unregisterArtistReleases(const Artist& artist) {
-    for (const ReleaseInfo& r : artist.releases) {
-        m_releaseToArtists.remove(r.id, artist.id);
+void SessionManager::unregisterArtistReleases(ArtistKey key) {
+    for (ReleaseKey release : std::as_const(m_releaseSets[key])) {
+        m_releaseToArtists.remove(release, key);
+        if (!m_releaseToArtists.contains(release)) m_releases.release(release);
     }
+    m_releaseSets[key] = ReleaseSet();
 }
 
 // Debug/query: who owns a release?
 QVector<QString> SessionManager::getArtistsForRelease(const QString& releaseId) const {
-    return m_releaseToArtists.values(releaseId).toVector();
+    QVector<QString> ids;
+    const auto keys = m_releaseToArtists.values(m_releases.find(releaseId));
+    for (ArtistKey key : keys) {
+        ids.append(m_artistIds.toString(key));
+    }
+    return ids;
 }
 
 
-void SessionManager::updateCollabsForNewArtist(const Artist& newArtist) {
-    for (const ReleaseInfo& rel : newArtist.releases) {
-        const auto others = m_releaseToArtists.values(rel.id);
-        for (const QString& otherId : others) {
-            if (otherId == newArtist.id) continue;
+qsizetype SessionManager::memoryEstimate() const {
+    qsizetype bytes = m_artistIds.memoryEstimate() + m_releases.memoryEstimate();
+    for (ArtistKey key : m_order) {
+        const Artist& artist = *m_artists.get(m_handles[key]);
+        bytes += qsizetype(sizeof(Artist)) + stringHeapBytes(artist.id) + stringHeapBytes(artist.name);
+        bytes += m_releaseSets[key].capacity() * qsizetype(sizeof(ReleaseKey));
+    }
+    // Release index: one node per (release, artist) pair.
+    bytes += m_releaseToArtists.size() * qsizetype(sizeof(ReleaseKey) + sizeof(ArtistKey) + sizeof(void*));
+    m_collabs.forEach([&](const CollabKey&, const ArtistCollaboration& releases) {
+        bytes += qsizetype(sizeof(CollabKey) + sizeof(ArtistCollaboration)) + releases.capacity() * qsizetype(sizeof(ReleaseKey));
+    });
+    return bytes;
+}
+
+// Collaborations between a new artist and the rest of the session. Within
+// a batch a pair is found from its larger key only, so it comes up once.
+SessionManager::NewCollabs SessionManager::findCollabsForNewArtist(ArtistKey newKey, const std::vector<char>& inBatch) const {
+    const ReleaseSet& releases = m_releaseSets[newKey];
 
-            CollabKey key(newArtist.id, otherId);
-            ArtistCollaboration& collab = m_collabs[key]; // inserts if missing
-            if (!collab.contains(rel.id)) {
-                collab.append(rel.id);
-                qDebug() << "Release match:" << rel.title << "; with artistId:" << otherId;
-            }
+    // Everyone sharing at least one release, each once.
+    QVector<ArtistKey> others;
+    for (ReleaseKey release : releases) {
+        const auto range = m_releaseToArtists.equal_range(release);
+        for (auto it = range.first; it != range.second; ++it) {
+            const ArtistKey other = *it;
+            if (other == newKey || (inBatch[other] && other > newKey)) continue;
+            others.append(other);
         }
     }
+    std::sort(others.begin(), others.end());
+    others.erase(std::unique(others.begin(), others.end()), others.end());
+
+    NewCollabs collabs;
+    collabs.reserve(size_t(others.size()));
+    for (ArtistKey other : std::as_const(others)) {
+        collabs.emplace_back(other, intersectReleases(releases, m_releaseSets[other]));
+    }
+    return collabs;
 }
 
 void SessionManager::clear() {
+    QMutexLocker locker(&sessionMutex);
+    CollabDelta delta;
+    delta.removed.reserve(qsizetype(m_collabs.size()));
+    m_collabs.forEach([&](const CollabKey& key, const ArtistCollaboration&) {
+        delta.removed.append(key);
+    });
+    for (ArtistKey key : std::as_const(m_order)) {
+        for (ReleaseKey release : std::as_const(m_releaseSets[key])) {
+            m_releases.release(release);
+        }
+    }
+
     m_artists.clear();
+    m_handles.clear();
+    m_releaseSets.clear();
+    m_order.clear();
+    m_rows.clear();
+    m_artistNames.clear();
     m_collabs.clear();
+    m_adjacency.clear();
+    m_releaseToArtists.clear();
+
+    delta.generation = publishSnapshot();
+    locker.unlock();
     emit sessionCleared();
+    emit collabsChanged(delta);
 }
@@ -6,47 +6,131 @@
 #include <QDebug>
 #include <QFileDialog>
 #include <QMutex>
+#include <QHash>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
 #include "artist.h"
-
-
-
-
+#include "idtable.h"
+#include "releasestore.h"
+#include "sessionsnapshot.h"
+#include "slotmap.h"
+
+
+
+
+// Stays valid while its artist is in the session; see SlotMap.
+using ArtistHandle = SlotMap<Artist>::Handle;
+
+// The artists of the current session and the collaborations among them.
+// Artists live in a slot map indexed by their interned ArtistKey, so
+// lookups, contains and removal do not scan the session. Rows (for the
+// list model) are in the order the artists were added, except that removal
+// moves the last row into the gap, so it never shifts or scans the rows. Artist and release
+// ids are interned on the way in, and collaborations and the release index
+// only hold keys. Each artist's releases are also kept as a sorted set, so a
+// collaboration is the intersection of two sets, and each artist's
+// collaborators are listed so removing it only touches its own edges.
+//
+// Changes are made on the GUI thread, which may also read the live state
+// below. Anyone else (or anything that keeps the data around, like the
+// layout thread) reads a SessionSnapshot instead; see snapshot().
 class SessionManager : public QObject {
     Q_OBJECT
 public:
     SessionManager(QObject* parent = nullptr);
 
-    const QVector<Artist>& artists() const { return m_artists; }
+    int artistCount() const { return int(m_order.size()); }
+    const Artist& artistAt(int row) const { return *m_artists.get(m_handles[m_order[row]]); }
     const SessionCollaborations& collabs() const { return m_collabs; }
 
-    bool containsArtist(const Artist& artist);
-    const Artist* getArtistById(const QString& artistId);
+    // Discogs id <-> key. Keys outlive clear(), so they are never reused.
+    const IdTable& artistIds() const { return m_artistIds; }
+    ArtistKey keyOf(const QString& artistId) const { return m_artistIds.find(artistId); }
+    ArtistKey internArtistId(const QString& artistId) { return m_artistIds.intern(artistId); }
+
+    ArtistHandle handleOf(ArtistKey key) const { return key < m_handles.size() ? m_handles[key] : ArtistHandle(); }
+    const Artist* artist(ArtistHandle handle) const { return m_artists.get(handle); }
+
+    // Session artists keep only id and name, and their releases only as
+    // keys into releases(), which holds each release's title and year once.
+    // Profiles, URLs and full release records are read from the DB on
+    // demand, see ArtistService::artistDetails().
+    const ReleaseSet& releasesOf(ArtistKey key) const {
+        static const ReleaseSet none;
+        return key < m_releaseSets.size() ? m_releaseSets[key] : none;
+    }
+    const ReleaseStore& releases() const { return m_releases; }
+
+    // Rough heap use of the session's artists, releases and collaborations.
+    // Walks the whole session; logged after each add when the
+    // music_tree.session.memory debug category is enabled.
+    qsizetype memoryEstimate() const;
+
+    bool containsArtist(const Artist& artist) const { return m_artists.contains(handleOf(keyOf(artist.id))); }
+    const Artist* getArtistById(const QString& artistId) const { return m_artists.get(handleOf(keyOf(artistId))); }
     void addArtist(const Artist& artist);
+    // Adds a batch in one pass: the release index and every new
+    // collaboration are built once for the whole batch, in parallel for
+    // large ones, and artistsAdded is emitted once. Artists already in the
+    // session (or repeated in the batch) are skipped.
+    void addArtists(const std::vector<Artist>& artists);
     void removeArtistById(const QString& artistId);
 
+    // The latest published state; cheap and safe from any thread.
+    SessionSnapshotPtr snapshot() const { return std::atomic_load(&m_snapshot); }
+    // Bumped by every change, so a reader that remembers the generation it
+    // last saw can tell whether anything changed without taking a snapshot.
+    quint64 generation() const { return m_generation.load(std::memory_order_acquire); }
+
     // debugging / queries
     QVector<QString> getArtistsForRelease(const QString& releaseId) const;
 
     void clear();
 
 signals:
-    void artistAdded(const Artist& artist);
-    void artistRemoved(const Artist& artist);
+    // New rows were appended at the end, one per key, in this order.
+    void artistsAdded(const QVector<ArtistKey>& keys);
+    // Emitted without the session lock, before anything changes; slots must
+    // not change the session. row is the artist's row: unless it is the
+    // last one, the last row's artist moves into it and the last row goes.
+    void artistAboutToBeRemoved(const Artist& artist, ArtistKey key, int row);
+    void artistRemoved(const Artist& artist, ArtistKey key);
     void sessionCleared();
+    // The edges each change touched, once per change and after the artist
+    // signals above, so consumers can update in O(delta) instead of
+    // rereading collabs().
+    void collabsChanged(const CollabDelta& delta);
 
 
 private:
 
-    void updateCollabsForNewArtist(const Artist& newArtist);
-    void removeCollabsForArtist(const QString& artistId);
+    using NewCollabs = std::vector<std::pair<ArtistKey, ArtistCollaboration>>;
+    NewCollabs findCollabsForNewArtist(ArtistKey newKey, const std::vector<char>& inBatch) const;
+    void removeCollabsForArtist(ArtistKey key, QVector<CollabKey>& removed);
+
+    quint64 publishSnapshot(); // returns the new generation
 
-    void registerArtistReleases(const Artist& artist);
-    void unregisterArtistReleases(const Artist& artist);
+    void internArtistReleases(const Artist& artist, ArtistKey key);
+    void registerArtistReleases(ArtistKey key);
+    void unregisterArtistReleases(ArtistKey key);
 
 
-    QVector<Artist> m_artists;
+    IdTable m_artistIds;
+    ReleaseStore m_releases;
+    SlotMap<Artist> m_artists;
+    std::vector<ArtistHandle> m_handles; // by ArtistKey, null when not in the session
+    std::vector<ReleaseSet> m_releaseSets; // by ArtistKey, empty when not in the session
+    QVector<ArtistKey> m_order; // rows
+    std::vector<int> m_rows; // by ArtistKey: its index in m_order
     SessionCollaborations m_collabs;
-    QMultiHash<QString, QString> m_releaseToArtists;  // releaseId -> artistId(s)
+    SessionArtistNames m_artistNames; // mirrors the session, for snapshots
+    std::vector<QVector<ArtistKey>> m_adjacency; // by ArtistKey: the other ends of its collabs
+    QMultiHash<ReleaseKey, ArtistKey> m_releaseToArtists;
+
+    QMutex sessionMutex; // serializes changes
 
-    QMutex sessionMutex;
+    std::atomic<quint64> m_generation{1};
+    SessionSnapshotPtr m_snapshot = std::make_shared<const SessionSnapshot>(SessionSnapshot{1, {}, {}});
 };
@@ -0,0 +1,26 @@
+#pragma once
+#include <QString>
+#include <memory>
+#include "artist.h"
+#include "persistentmap.h"
+
+struct ArtistKeyBits {
+    quint64 operator()(ArtistKey key) const { return key; }
+};
+
+// Names of the artists in the session, by key.
+using SessionArtistNames = PersistentMap<ArtistKey, QString, ArtistKeyBits>;
+
+// The session as of one generation. Never modified once published: the
+// session swaps in a new one after every change, so readers on any thread
+// can keep one as long as they like without holding a lock. Both maps
+// share all unchanged nodes with the session's own, so publishing costs
+// O(1) however large the session is; a change only pays for the paths it
+// rewrote.
+struct SessionSnapshot {
+    quint64 generation = 0;
+    SessionArtistNames artists;
+    SessionCollaborations collabs;
+};
+
+using SessionSnapshotPtr = std::shared_ptr<const SessionSnapshot>;
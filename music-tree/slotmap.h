@@ -0,0 +1,85 @@
+#pragma once
+#include <QtGlobal>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Values in reusable slots, addressed by generational handles.
+// insert(), remove() and get() are O(1). A handle names one value: once the
+// value is removed its slot may be reused, but the slot's generation moves
+// on, so the old handle resolves to nullptr instead of to the newcomer.
+// Pointers returned by get() are invalidated by the next insert().
+template <typename T>
+class SlotMap {
+public:
+    struct Handle {
+        quint32 index = nullIndex;
+        quint32 generation = 0;
+
+        bool isNull() const { return index == nullIndex; }
+        bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const Handle& other) const { return !(*this == other); }
+    };
+
+    Handle insert(T value) {
+        quint32 index;
+        if (!m_free.empty()) {
+            index = m_free.back();
+            m_free.pop_back();
+        } else {
+            index = quint32(m_slots.size());
+            m_slots.emplace_back();
+        }
+        Slot& slot = m_slots[index];
+        slot.value.emplace(std::move(value));
+        ++m_size;
+        return {index, slot.generation};
+    }
+
+    // Returns false if the handle was already stale.
+    bool remove(Handle handle) {
+        if (!contains(handle)) return false;
+        Slot& slot = m_slots[handle.index];
+        slot.value.reset();
+        ++slot.generation;
+        m_free.push_back(handle.index);
+        --m_size;
+        return true;
+    }
+
+    bool contains(Handle handle) const {
+        return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation
+               && m_slots[handle.index].value.has_value();
+    }
+
+    T* get(Handle handle) { return contains(handle) ? &*m_slots[handle.index].value : nullptr; }
+    const T* get(Handle handle) const { return contains(handle) ? &*m_slots[handle.index].value : nullptr; }
+
+    int size() const { return m_size; }
+
+    // Empties every slot; handles from before stay stale.
+    void clear() {
+        m_free.clear();
+        for (quint32 index = 0; index < m_slots.size(); ++index) {
+            Slot& slot = m_slots[index];
+            if (slot.value) {
+                slot.value.reset();
+                ++slot.generation;
+            }
+            m_free.push_back(index);
+        }
+        m_size = 0;
+    }
+
+private:
+    static constexpr quint32 nullIndex = ~quint32(0);
+
+    struct Slot {
+        std::optional<T> value;
+        quint32 generation = 0;
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<quint32> m_free;
+    int m_size = 0;
+};
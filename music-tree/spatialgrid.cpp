@@ -0,0 +1,96 @@
+#include "spatialgrid.h"
+#include <algorithm>
+#include <cmath>
+
+void SpatialGrid::build(const double* x, const double* y, int count, double cellSize) {
+    m_x = x;
+    m_y = y;
+    m_count = count;
+    m_cellStart.clear();
+    m_items.clear();
+    m_cols = m_rows = 0;
+    if (count <= 0) return;
+
+    double minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+    for (int i = 1; i < count; ++i) {
+        minX = std::min(minX, x[i]);
+        maxX = std::max(maxX, x[i]);
+        minY = std::min(minY, y[i]);
+        maxY = std::max(maxY, y[i]);
+    }
+
+    // Keep the cell count within a small multiple of the point count.
+    const double width = maxX - minX, height = maxY - minY;
+    const double minCell = std::sqrt(std::max(width * height, 1.0) / (2.0 * count));
+    m_cellSize = std::max({cellSize, minCell, 1e-6});
+    m_originX = minX;
+    m_originY = minY;
+    m_cols = int(width / m_cellSize) + 1;
+    m_rows = int(height / m_cellSize) + 1;
+
+    // Counting sort: histogram, prefix sum, scatter.
+    std::vector<int> cellOf(count);
+    m_cellStart.assign(size_t(m_cols) * m_rows + 1, 0);
+    for (int i = 0; i < count; ++i) {
+        const int c = cellCoord(y[i], m_originY, m_rows) * m_cols + cellCoord(x[i], m_originX, m_cols);
+        cellOf[i] = c;
+        ++m_cellStart[c + 1];
+    }
+    for (size_t c = 1; c < m_cellStart.size(); ++c) {
+        m_cellStart[c] += m_cellStart[c - 1];
+    }
+    m_items.resize(count);
+    std::vector<int> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (int i = 0; i < count; ++i) {
+        m_items[fill[cellOf[i]]++] = i;
+    }
+}
+
+int SpatialGrid::cellCoord(double v, double origin, int cells) const {
+    const double c = std::floor((v - origin) / m_cellSize);
+    return int(std::clamp(c, 0.0, double(cells - 1)));
+}
+
+int SpatialGrid::nearest(double px, double py, double radius) const {
+    if (m_count == 0) return -1;
+
+    const int c0 = cellCoord(px - radius, m_originX, m_cols), c1 = cellCoord(px + radius, m_originX, m_cols);
+    const int r0 = cellCoord(py - radius, m_originY, m_rows), r1 = cellCoord(py + radius, m_originY, m_rows);
+
+    int best = -1;
+    double bestD2 = radius * radius;
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const int cell = r * m_cols + c;
+            for (int k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) {
+                const int i = m_items[k];
+                const double dx = m_x[i] - px, dy = m_y[i] - py;
+                const double d2 = dx * dx + dy * dy;
+                if (d2 <= bestD2) {
+                    bestD2 = d2;
+                    best = i;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void SpatialGrid::queryRect(double left, double top, double right, double bottom, std::vector<int>& out) const {
+    if (m_count == 0 || left > right || top > bottom) return;
+
+    const int c0 = cellCoord(left, m_originX, m_cols), c1 = cellCoord(right, m_originX, m_cols);
+    const int r0 = cellCoord(top, m_originY, m_rows), r1 = cellCoord(bottom, m_originY, m_rows);
+
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const int cell = r * m_cols + c;
+            for (int k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) {
+                const int i = m_items[k];
+                if (m_x[i] >= left && m_x[i] <= right && m_y[i] >= top && m_y[i] <= bottom) {
+                    out.push_back(i);
+                }
+            }
+        }
+    }
+}
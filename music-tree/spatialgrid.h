@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+
+// Uniform grid over node positions for hit testing and area queries.
+// build() bins every point with a counting sort into a compact cell array;
+// queries then only visit the cells overlapping the search area, so their
+// cost depends on how many nodes are near the query rather than on the
+// total node count.
+class SpatialGrid {
+public:
+    // cellSize is a lower bound: cells grow if the points are spread so wide
+    // that the grid would have far more cells than points.
+    void build(const double* x, const double* y, int count, double cellSize);
+
+    // Index of the point nearest to (px, py) within radius, or -1.
+    int nearest(double px, double py, double radius) const;
+
+    // Appends the indices of all points inside the rectangle to 'out'.
+    void queryRect(double left, double top, double right, double bottom, std::vector<int>& out) const;
+
+    bool isEmpty() const { return m_count == 0; }
+
+private:
+    int cellCoord(double v, double origin, int cells) const;
+
+    const double* m_x = nullptr;
+    const double* m_y = nullptr;
+    int m_count = 0;
+
+    double m_originX = 0.0, m_originY = 0.0;
+    double m_cellSize = 1.0;
+    int m_cols = 0, m_rows = 0;
+    std::vector<int> m_cellStart; // m_cols * m_rows + 1 offsets into m_items
+    std::vector<int> m_items;     // point indices grouped by cell
+};
@@ -0,0 +1,263 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "layoutengine.h"
+
+// Sparse stress majorization (Ortmann, Klimenta and Brandes): every node is
+// moved to the weighted mean of where each of its terms wants it, which
+// lowers the stress sum w_ij (|x_i - x_j| - d_ij)^2 with d_ij the graph
+// distance. Full stress needs all n^2 distances; the sparse variant keeps
+// the edges plus the distances to a few pivots, each pivot standing in for
+// the nodes closer to it than to any other pivot. Edge lengths come from
+// EdgeWeightPolicy: an edge of weight w is 1 / w spring lengths long.
+//
+// No forces and no momentum: positions only depend on graph distances, so
+// it tends to unfold long chains and trees that the force models fold up.
+//
+// Single-threaded: step() runs on the layout thread and does not use the
+// ForcePool. Each move reads the positions its predecessors just wrote, so
+// splitting the pass over threads would need a Jacobi pass into a second
+// buffer instead, which converges more slowly and can oscillate.
+template <typename EdgeWeightPolicy>
+class StressLayout final : public LayoutEngine {
+public:
+    const char* name() const override { return "Stress majorization"; }
+
+    void restart(const LayoutStore& store, const LayoutParams&, bool topologyChanged) override {
+        if (topologyChanged || m_termStart.size() != size_t(store.size()) + 1) {
+            buildTerms(store);
+        }
+    }
+
+    void step(LayoutStore& store, const LayoutParams& params) override {
+        const int n = store.size();
+        if (m_termStart.size() != size_t(n) + 1) buildTerms(store);
+        double* x = store.x.data();
+        double* y = store.y.data();
+        const double length = params.springLength;
+
+        // In place, in index order (Gauss-Seidel): with symmetric terms every
+        // move lowers the stress, so the layout settles instead of swinging.
+        for (int i = 0; i < n; ++i) {
+            double sumX = 0.0, sumY = 0.0, sumW = 0.0;
+            for (int t = m_termStart[i]; t < m_termStart[i + 1]; ++t) {
+                const int j = m_termNode[t];
+                const double target = m_termDist[t] * length;
+                const double dx = x[i] - x[j];
+                const double dy = y[i] - y[j];
+                const double dist = std::sqrt(dx * dx + dy * dy);
+                const double w = m_termWeight[t];
+                if (dist > 1e-9) {
+                    sumX += w * (x[j] + target * dx / dist);
+                    sumY += w * (y[j] + target * dy / dist);
+                } else {
+                    // Coincident: pick a direction that differs per pair.
+                    sumX += w * (x[j] + target * (i < j ? -1.0 : 1.0));
+                    sumY += w * y[j];
+                }
+                sumW += w;
+            }
+            if (sumW == 0.0) continue;
+
+            double dx = sumX / sumW - x[i];
+            double dy = sumY / sumW - y[i];
+            capStep(dx, dy, params.maxStep);
+            x[i] += dx;
+            y[i] += dy;
+            store.vx[i] = dx;
+            store.vy[i] = dy;
+        }
+    }
+
+private:
+    static constexpr int pivotCount = 32;
+    static constexpr size_t maxLocalTerms = 48;
+
+    void buildTerms(const LayoutStore& store) {
+        const int n = store.size();
+        const int edgeCount = store.edgeCount();
+        m_termStart.assign(n + 1, 0);
+        m_termNode.clear();
+        m_termDist.clear();
+        m_termWeight.clear();
+        if (n == 0) return;
+
+        // Weighted adjacency, CSR.
+        std::vector<int> start(n + 1, 0);
+        for (int e = 0; e < edgeCount; ++e) {
+            ++start[store.edgeA[e] + 1];
+            ++start[store.edgeB[e] + 1];
+        }
+        for (int i = 0; i < n; ++i) start[i + 1] += start[i];
+        std::vector<int> adjacent(start[n]);
+        std::vector<double> edgeLength(start[n]);
+        {
+            std::vector<int> fill(start.begin(), start.end() - 1);
+            for (int e = 0; e < edgeCount; ++e) {
+                const int a = store.edgeA[e], b = store.edgeB[e];
+                const double len = 1.0 / EdgeWeightPolicy::weight(store.edgeWeight[e]);
+                adjacent[fill[a]] = b;
+                edgeLength[fill[a]++] = len;
+                adjacent[fill[b]] = a;
+                edgeLength[fill[b]++] = len;
+            }
+        }
+
+        // Pivots by farthest-first selection, starting from the best
+        // connected node; unreachable nodes count as farthest, so every
+        // component gets a pivot while there are pivots left.
+        const double inf = std::numeric_limits<double>::infinity();
+        const int pivots = std::min(n, pivotCount);
+        std::vector<std::vector<double>> dist(pivots);
+        std::vector<double> nearest(n, inf);
+        std::vector<int> region(n, -1); // closest pivot
+        int next = 0;
+        for (int i = 1; i < n; ++i) {
+            if (start[i + 1] - start[i] > start[next + 1] - start[next]) next = i;
+        }
+        std::vector<int> pivotNode(pivots);
+        for (int p = 0; p < pivots; ++p) {
+            pivotNode[p] = next;
+            shortestPaths(next, start, adjacent, edgeLength, dist[p]);
+            int farthest = -1;
+            for (int i = 0; i < n; ++i) {
+                if (dist[p][i] < nearest[i]) {
+                    nearest[i] = dist[p][i];
+                    region[i] = p;
+                }
+                if (farthest < 0 || nearest[i] > nearest[farthest]) farthest = i;
+            }
+            if (nearest[farthest] == 0.0) break; // every node is a pivot
+            next = farthest;
+        }
+
+        // Distances within each pivot's region, to weigh a pivot term by how
+        // many nodes it stands in for.
+        std::vector<std::vector<double>> regionDist(pivots);
+        double maxDist = 1.0;
+        for (int i = 0; i < n; ++i) {
+            if (region[i] >= 0) regionDist[region[i]].push_back(nearest[i]);
+        }
+        for (auto& d : regionDist) std::sort(d.begin(), d.end());
+        for (const auto& d : dist) {
+            for (double v : d) {
+                if (v < inf) maxDist = std::max(maxDist, v);
+            }
+        }
+        // Other components are kept about one graph diameter away, lightly.
+        const double unreachable = maxDist + 1.0;
+
+        // Local terms: neighbours and, up to maxLocalTerms, neighbours of
+        // neighbours. The latter keep artists sharing a collaborator apart,
+        // which no pivot term would.
+        std::vector<Term> terms;
+        std::vector<double> local(n, inf);
+        std::vector<int> touched;
+        for (int i = 0; i < n; ++i) {
+            touched.clear();
+            const auto reach = [&](int j, double d) {
+                if (j == i) return;
+                if (local[j] == inf) touched.push_back(j);
+                local[j] = std::min(local[j], d);
+            };
+            for (int k = start[i]; k < start[i + 1]; ++k) {
+                reach(adjacent[k], edgeLength[k]);
+            }
+            const size_t direct = touched.size();
+            for (size_t t = 0; t < direct; ++t) {
+                const int nb = touched[t];
+                for (int k = start[nb]; k < start[nb + 1] && touched.size() < maxLocalTerms; ++k) {
+                    reach(adjacent[k], local[nb] + edgeLength[k]);
+                }
+            }
+            for (int j : touched) {
+                terms.push_back(makeTerm(i, j, local[j], 1.0));
+                local[j] = inf;
+            }
+        }
+        // Pivot terms, weighted by the nodes the pivot stands in for.
+        for (int i = 0; i < n; ++i) {
+            for (int p = 0; p < pivots && !dist[p].empty(); ++p) {
+                if (pivotNode[p] == i) continue;
+                const double d = dist[p][i];
+                if (d < inf) {
+                    const auto& r = regionDist[p];
+                    const double members = double(std::upper_bound(r.begin(), r.end(), d / 2.0) - r.begin());
+                    terms.push_back(makeTerm(i, pivotNode[p], d, std::max(1.0, members)));
+                } else {
+                    terms.push_back(makeTerm(i, pivotNode[p], unreachable, 1.0));
+                }
+            }
+        }
+
+        // Each pair once (local terms win over pivot terms, being exact),
+        // then listed under both endpoints: symmetric terms are what makes
+        // the update a descent on one stress function.
+        std::stable_sort(terms.begin(), terms.end(), [](const Term& l, const Term& r) {
+            return l.a != r.a ? l.a < r.a : l.b < r.b;
+        });
+        terms.erase(std::unique(terms.begin(), terms.end(), [](const Term& l, const Term& r) {
+            return l.a == r.a && l.b == r.b;
+        }), terms.end());
+
+        for (const Term& t : terms) {
+            ++m_termStart[t.a + 1];
+            ++m_termStart[t.b + 1];
+        }
+        for (int i = 0; i < n; ++i) m_termStart[i + 1] += m_termStart[i];
+        m_termNode.resize(m_termStart[n]);
+        m_termDist.resize(m_termStart[n]);
+        m_termWeight.resize(m_termStart[n]);
+        std::vector<int> fill(m_termStart.begin(), m_termStart.end() - 1);
+        for (const Term& t : terms) {
+            const int ka = fill[t.a]++, kb = fill[t.b]++;
+            m_termNode[ka] = t.b;
+            m_termNode[kb] = t.a;
+            m_termDist[ka] = m_termDist[kb] = t.dist;
+            m_termWeight[ka] = m_termWeight[kb] = t.weight;
+        }
+    }
+
+    struct Term {
+        int a, b; // a < b
+        double dist, weight;
+    };
+
+    static Term makeTerm(int i, int j, double d, double count) {
+        return {std::min(i, j), std::max(i, j), d, count / (d * d)};
+    }
+
+    static void shortestPaths(int source, const std::vector<int>& start, const std::vector<int>& adjacent,
+                              const std::vector<double>& edgeLength, std::vector<double>& dist) {
+        const int n = int(start.size()) - 1;
+        dist.assign(n, std::numeric_limits<double>::infinity());
+        using Entry = std::pair<double, int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        dist[source] = 0.0;
+        queue.emplace(0.0, source);
+        while (!queue.empty()) {
+            const auto [d, u] = queue.top();
+            queue.pop();
+            if (d > dist[u]) continue;
+            for (int k = start[u]; k < start[u + 1]; ++k) {
+                const double nd = d + edgeLength[k];
+                if (nd < dist[adjacent[k]]) {
+                    dist[adjacent[k]] = nd;
+                    queue.emplace(nd, adjacent[k]);
+                }
+            }
+        }
+    }
+
+    // Terms of node i are [m_termStart[i], m_termStart[i + 1]); distances
+    // are in spring lengths so a length change needs no rebuild.
+    std::vector<int> m_termStart;
+    std::vector<int> m_termNode;
+    std::vector<double> m_termDist;
+    std::vector<double> m_termWeight;
+};
@@ -0,0 +1,109 @@
+// intersectReleases() against std::set_intersection, on sets of similar
+// size (the merge) and of very different size (galloping).
+#include <QtTest>
+#include <algorithm>
+#include <random>
+#include "artist.h"
+
+namespace {
+
+// count distinct keys below limit, ascending.
+ReleaseSet randomSet(std::mt19937& random, qsizetype count, ReleaseKey limit) {
+    std::vector<ReleaseKey> keys;
+    keys.reserve(size_t(count) * 2);
+    while (qsizetype(keys.size()) < count * 2) keys.push_back(ReleaseKey(random() % limit));
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::shuffle(keys.begin(), keys.end(), random);
+    keys.resize(std::min(keys.size(), size_t(count)));
+    std::sort(keys.begin(), keys.end());
+    return ReleaseSet(keys.begin(), keys.end());
+}
+
+ReleaseSet reference(const ReleaseSet& a, const ReleaseSet& b) {
+    ReleaseSet shared;
+    std::set_intersection(a.cbegin(), a.cend(), b.cbegin(), b.cend(), std::back_inserter(shared));
+    return shared;
+}
+
+} // namespace
+
+class TestIntersectReleases : public QObject {
+    Q_OBJECT
+
+private slots:
+    void edgeCases();
+    void merge_data();
+    void merge();
+    void gallop_data();
+    void gallop();
+};
+
+void TestIntersectReleases::edgeCases() {
+    const ReleaseSet empty;
+    const ReleaseSet some{1, 5, 9};
+    QVERIFY(intersectReleases(empty, some).isEmpty());
+    QVERIFY(intersectReleases(some, empty).isEmpty());
+    QCOMPARE(intersectReleases(some, some), some);
+
+    // Galloping: the shared keys at the very start and end of the large set,
+    // and keys of the small set beyond its end.
+    ReleaseSet large;
+    for (ReleaseKey k = 0; k < 1000; ++k) large.append(k * 2);
+    QCOMPARE(intersectReleases(ReleaseSet{0, 1998}, large), (ReleaseSet{0, 1998}));
+    QCOMPARE(intersectReleases(large, ReleaseSet{1, 1997, 1999, 5000}), ReleaseSet());
+    QCOMPARE(intersectReleases(ReleaseSet{500, 1998, 4000}, large), (ReleaseSet{500, 1998}));
+}
+
+void TestIntersectReleases::merge_data() {
+    QTest::addColumn<int>("smallSize");
+    QTest::addColumn<int>("largeSize");
+    QTest::addColumn<int>("limit");
+    QTest::newRow("equal, dense") << 500 << 500 << 1000;
+    QTest::newRow("equal, sparse") << 500 << 500 << 100000;
+    QTest::newRow("just below the gallop ratio") << 100 << 799 << 2000;
+}
+
+void TestIntersectReleases::merge() {
+    QFETCH(int, smallSize);
+    QFETCH(int, largeSize);
+    QFETCH(int, limit);
+    std::mt19937 random(smallSize ^ largeSize ^ limit);
+    for (int round = 0; round < 20; ++round) {
+        const ReleaseSet a = randomSet(random, smallSize, ReleaseKey(limit));
+        const ReleaseSet b = randomSet(random, largeSize, ReleaseKey(limit));
+        QCOMPARE(intersectReleases(a, b), reference(a, b));
+        QCOMPARE(intersectReleases(b, a), reference(a, b));
+    }
+}
+
+void TestIntersectReleases::gallop_data() {
+    QTest::addColumn<int>("smallSize");
+    QTest::addColumn<int>("largeSize");
+    QTest::addColumn<int>("limit");
+    QTest::newRow("at the gallop ratio") << 100 << 800 << 2000;
+    QTest::newRow("one key") << 1 << 5000 << 10000;
+    QTest::newRow("few keys, dense") << 10 << 5000 << 12000;
+    QTest::newRow("few keys, sparse") << 30 << 20000 << 1000000;
+}
+
+void TestIntersectReleases::gallop() {
+    QFETCH(int, smallSize);
+    QFETCH(int, largeSize);
+    QFETCH(int, limit);
+    std::mt19937 random(smallSize ^ largeSize ^ limit);
+    for (int round = 0; round < 50; ++round) {
+        const ReleaseSet large = randomSet(random, largeSize, ReleaseKey(limit));
+        // Half the small set taken from the large one, so there are matches.
+        ReleaseSet small = randomSet(random, smallSize - smallSize / 2, ReleaseKey(limit));
+        for (int i = 0; i < smallSize / 2; ++i) small.append(large[random() % large.size()]);
+        std::sort(small.begin(), small.end());
+        small.erase(std::unique(small.begin(), small.end()), small.end());
+
+        QCOMPARE(intersectReleases(small, large), reference(small, large));
+        QCOMPARE(intersectReleases(large, small), reference(small, large));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestIntersectReleases)
+#include "tst_intersectreleases.moc"
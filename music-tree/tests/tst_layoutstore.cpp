@@ -0,0 +1,190 @@
+// LayoutStore's swap-removals: after any sequence of node and edge changes
+// the edge arrays, incidence lists and edge index must describe the same
+// graph as a plain reference.
+#include <QtTest>
+#include <algorithm>
+#include <map>
+#include <random>
+#include "layoutstore.h"
+
+namespace {
+
+struct Reference {
+    std::map<ArtistKey, double> nodes;                           // key -> x it was added at
+    std::map<std::pair<ArtistKey, ArtistKey>, double> edges;    // (a < b) -> weight
+
+    void removeNode(ArtistKey artist) {
+        nodes.erase(artist);
+        for (auto it = edges.begin(); it != edges.end();) {
+            if (it->first.first == artist || it->first.second == artist) it = edges.erase(it);
+            else ++it;
+        }
+    }
+};
+
+// Returns an empty string if the store matches, else what is wrong.
+QString mismatch(const LayoutStore& store, const Reference& reference) {
+    const int n = store.size();
+    const int edgeCount = store.edgeCount();
+    if (n != int(reference.nodes.size())) return QStringLiteral("node count");
+    if (edgeCount != int(reference.edges.size())) return QStringLiteral("edge count");
+    if (store.ids.size() != n || store.names.size() != n || int(store.y.size()) != n
+        || int(store.vx.size()) != n || int(store.vy.size()) != n) {
+        return QStringLiteral("node array sizes");
+    }
+    if (int(store.edgeB.size()) != edgeCount || int(store.edgeWeight.size()) != edgeCount) {
+        return QStringLiteral("edge array sizes");
+    }
+
+    // Each node's data moved with it.
+    for (int i = 0; i < n; ++i) {
+        const ArtistKey artist = store.ids[i];
+        const auto it = reference.nodes.find(artist);
+        if (it == reference.nodes.end()) return QStringLiteral("unknown node %1").arg(artist);
+        if (store.indexOf(artist) != i) return QStringLiteral("indexOf(%1)").arg(artist);
+        if (store.x[i] != it->second || store.names[i] != QString::number(artist)) {
+            return QStringLiteral("data of node %1").arg(artist);
+        }
+    }
+
+    // Each edge is found under its key and in both endpoints' lists.
+    std::vector<int> seen(edgeCount, 0);
+    for (int e = 0; e < edgeCount; ++e) {
+        const int a = store.edgeA[e], b = store.edgeB[e];
+        if (a < 0 || a >= n || b < 0 || b >= n) return QStringLiteral("endpoints of edge %1").arg(e);
+        const CollabKey key(store.ids[a], store.ids[b]);
+        const auto it = reference.edges.find({key.a, key.b});
+        if (it == reference.edges.end()) return QStringLiteral("unknown edge %1").arg(e);
+        if (store.edgeWeight[e] != it->second) return QStringLiteral("weight of edge %1").arg(e);
+        if (store.edgeIndex(key) != e) return QStringLiteral("edgeIndex of edge %1").arg(e);
+        for (int node : {a, b}) {
+            const std::vector<int>& incident = store.incidentEdges(node);
+            if (std::count(incident.begin(), incident.end(), e) != 1) {
+                return QStringLiteral("edge %1 in the list of node %2").arg(e).arg(node);
+            }
+        }
+    }
+
+    // And the lists hold nothing else.
+    for (int i = 0; i < n; ++i) {
+        for (int e : store.incidentEdges(i)) {
+            if (e < 0 || e >= edgeCount || (store.edgeA[e] != i && store.edgeB[e] != i)) {
+                return QStringLiteral("stale entry %1 in the list of node %2").arg(e).arg(i);
+            }
+            ++seen[e];
+        }
+    }
+    for (int e = 0; e < edgeCount; ++e) {
+        if (seen[e] != 2) return QStringLiteral("edge %1 listed %2 times").arg(e).arg(seen[e]);
+    }
+    return QString();
+}
+
+} // namespace
+
+class TestLayoutStore : public QObject {
+    Q_OBJECT
+
+private slots:
+    void removeNodeRepointsMovedEdges();
+    void removeEdgeKeepsIndices();
+    void randomEdits();
+};
+
+void TestLayoutStore::removeNodeRepointsMovedEdges() {
+    LayoutStore store;
+    Reference reference;
+    for (ArtistKey k = 1; k <= 4; ++k) {
+        store.addNode(k, QString::number(k), QPointF(k, 0));
+        reference.nodes[k] = k;
+    }
+    // A path 1-2-3-4 plus 4-1; node 4 is last and moves into 2's index.
+    for (auto [a, b] : {std::pair<ArtistKey, ArtistKey>{1, 2}, {2, 3}, {3, 4}, {1, 4}}) {
+        QVERIFY(store.addEdge(CollabKey(a, b), a + b));
+        reference.edges[{a, b}] = a + b;
+    }
+    QVERIFY(!store.addEdge(CollabKey(2, 1), 1.0)); // already present
+    QVERIFY(!store.addEdge(CollabKey(1, 9), 1.0)); // missing endpoint
+
+    QVERIFY(store.removeNode(2));
+    reference.removeNode(2);
+    QCOMPARE(store.indexOf(4), 1);
+    QCOMPARE(store.indexOf(2), -1);
+    QCOMPARE(mismatch(store, reference), QString());
+    QCOMPARE(store.edgeIndex(CollabKey(1, 2)), -1);
+    QVERIFY(!store.removeNode(2));
+}
+
+void TestLayoutStore::removeEdgeKeepsIndices() {
+    LayoutStore store;
+    Reference reference;
+    for (ArtistKey k = 0; k < 6; ++k) {
+        store.addNode(k, QString::number(k), QPointF(k, 0));
+        reference.nodes[k] = k;
+    }
+    // A star around 0 and a ring, so the moved edge shares an endpoint with
+    // the removed one in some removals and not in others.
+    for (ArtistKey k = 1; k < 6; ++k) {
+        store.addEdge(CollabKey(0, k), k);
+        reference.edges[{0, k}] = k;
+        const ArtistKey next = k % 5 + 1;
+        store.addEdge(CollabKey(k, next), 10 + k);
+        reference.edges[{std::min(k, next), std::max(k, next)}] = 10 + k;
+    }
+    QCOMPARE(mismatch(store, reference), QString());
+
+    for (auto [a, b] : {std::pair<ArtistKey, ArtistKey>{0, 1}, {2, 3}, {0, 5}, {1, 5}, {0, 3}}) {
+        QVERIFY(store.removeEdge(CollabKey(b, a)));
+        QVERIFY(!store.removeEdge(CollabKey(a, b)));
+        reference.edges.erase({a, b});
+        QCOMPARE(mismatch(store, reference), QString());
+    }
+}
+
+void TestLayoutStore::randomEdits() {
+    constexpr ArtistKey keyCount = 40;
+    std::mt19937 random(7);
+    LayoutStore store;
+    Reference reference;
+    for (int op = 0; op < 20000; ++op) {
+        const ArtistKey a = random() % keyCount;
+        const ArtistKey b = random() % keyCount;
+        switch (random() % 8) {
+        case 0:
+        case 1: {
+            const double x = random() % 1000;
+            const bool known = reference.nodes.count(a);
+            store.addNode(a, QString::number(a), QPointF(x, 0));
+            if (!known) reference.nodes[a] = x;
+            break;
+        }
+        case 2:
+            QCOMPARE(store.removeNode(a), reference.nodes.count(a) == 1);
+            reference.removeNode(a);
+            break;
+        case 3:
+        case 4:
+        case 5: {
+            if (a == b) break; // the session has no edge from an artist to itself
+            const double weight = 1 + random() % 20;
+            const bool added = reference.nodes.count(a) && reference.nodes.count(b)
+                               && !reference.edges.count({std::min(a, b), std::max(a, b)});
+            QCOMPARE(store.addEdge(CollabKey(a, b), weight), added);
+            if (added) reference.edges[{std::min(a, b), std::max(a, b)}] = weight;
+            break;
+        }
+        default:
+            QCOMPARE(store.removeEdge(CollabKey(a, b)), reference.edges.erase({std::min(a, b), std::max(a, b)}) == 1);
+            break;
+        }
+        if (op % 97 == 0) QCOMPARE(mismatch(store, reference), QString());
+    }
+    QCOMPARE(mismatch(store, reference), QString());
+
+    store.clear();
+    QCOMPARE(store.size(), 0);
+    QCOMPARE(store.edgeCount(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestLayoutStore)
+#include "tst_layoutstore.moc"
@@ -0,0 +1,70 @@
+// LayoutWorker driven through its command queue: each post() is applied
+// from the event loop and publishes a frame.
+#include <QtTest>
+#include "layoutworker.h"
+
+class TestLayoutWorker : public QObject {
+    Q_OBJECT
+
+private slots:
+    void clearDropsNodesAndEdges();
+
+private:
+    // Waits for the frame the posted commands publish.
+    static const LayoutFrame& nextFrame(LayoutWorker& worker, QSignalSpy& frames);
+};
+
+const LayoutFrame& TestLayoutWorker::nextFrame(LayoutWorker& worker, QSignalSpy& frames) {
+    if (frames.isEmpty()) frames.wait();
+    frames.clear();
+    worker.acquireFrame();
+    return worker.frame();
+}
+
+void TestLayoutWorker::clearDropsNodesAndEdges() {
+    LayoutWorker worker;
+    QSignalSpy frames(&worker, &LayoutWorker::frameReady);
+
+    worker.post(AddNodeCommand{1, QStringLiteral("A"), QPointF(0, 0), true});
+    worker.post(AddNodeCommand{2, QStringLiteral("B"), QPointF(100, 0), true});
+    CollabDelta added;
+    added.generation = 1;
+    added.added.append(CollabEdge{CollabKey(1, 2), 3});
+    worker.post(UpdateEdgesCommand{added, nullptr});
+    {
+        const LayoutFrame& frame = nextFrame(worker, frames);
+        QVERIFY(frame.topology);
+        QCOMPARE(frame.topology->ids.size(), qsizetype(2));
+        QCOMPARE(frame.topology->edgeA.size(), size_t(1));
+    }
+
+    // What SessionManager::clear() leads to: the clear, then the delta
+    // removing the session's edges.
+    worker.post(ClearCommand{});
+    CollabDelta removed;
+    removed.generation = 2;
+    removed.removed.append(CollabKey(1, 2));
+    worker.post(UpdateEdgesCommand{removed, nullptr});
+    {
+        const LayoutFrame& frame = nextFrame(worker, frames);
+        QVERIFY(frame.topology);
+        QCOMPARE(frame.topology->ids.size(), qsizetype(0));
+        QCOMPARE(frame.topology->edgeA.size(), size_t(0));
+        QCOMPARE(frame.x.size(), size_t(0));
+        QVERIFY(frame.allChanged);
+    }
+
+    // The next session starts from an empty graph; a former key comes back
+    // as a new node.
+    worker.post(AddNodeCommand{2, QStringLiteral("B"), QPointF(5, 5), true});
+    {
+        const LayoutFrame& frame = nextFrame(worker, frames);
+        QCOMPARE(frame.topology->ids.size(), qsizetype(1));
+        QCOMPARE(frame.topology->ids[0], ArtistKey(2));
+        QCOMPARE(frame.x[0], 5.0);
+        QCOMPARE(frame.y[0], 5.0);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestLayoutWorker)
+#include "tst_layoutworker.moc"
@@ -0,0 +1,150 @@
+// PersistentMap against std::map, with keys chosen to share long runs of
+// their trie path, and copies that must not see each other's changes.
+#include <QtTest>
+#include <map>
+#include <random>
+#include "persistentmap.h"
+
+namespace {
+
+// Undoes PersistentMap's bit mix (the splitmix64 finalizer), so a key's
+// trie path is the key itself and tests can pick where paths part.
+struct PathBits {
+    quint64 operator()(quint64 key) const {
+        key ^= (key >> 31) ^ (key >> 62);
+        key *= 0x319642b2d24d8ec3ull;
+        key ^= (key >> 27) ^ (key >> 54);
+        key *= 0x96de1b173f119089ull;
+        key ^= (key >> 30) ^ (key >> 60);
+        return key;
+    }
+};
+
+using Map = PersistentMap<quint64, int, PathBits>;
+using Reference = std::map<quint64, int>;
+
+// Keys that agree with a common prefix below bit shift (the first
+// shift / 5 trie levels) and differ from it above: at shift 5 they part at
+// the second level, at 60 only at the last.
+std::vector<quint64> collidingKeys() {
+    const quint64 prefix = 0x0123456789abcdefull;
+    std::vector<quint64> keys;
+    for (int shift : {5, 10, 25, 50, 55, 60}) {
+        const quint64 low = prefix & ((quint64(1) << shift) - 1);
+        for (quint64 high = 1; high < 4; ++high) {
+            const quint64 key = low | (high << shift);
+            if (key != prefix) keys.push_back(key);
+        }
+    }
+    keys.push_back(prefix);
+    return keys;
+}
+
+bool sameContents(const Map& map, const Reference& reference) {
+    if (map.size() != qsizetype(reference.size())) return false;
+    for (const auto& [key, value] : reference) {
+        const int* found = map.find(key);
+        if (!found || *found != value) return false;
+    }
+    bool onlyKnown = true;
+    map.forEach([&](quint64 key, int value) {
+        const auto it = reference.find(key);
+        if (it == reference.end() || it->second != value) onlyKnown = false;
+    });
+    return onlyKnown;
+}
+
+} // namespace
+
+class TestPersistentMap : public QObject {
+    Q_OBJECT
+
+private slots:
+    void insertFindRemoveWithSharedPrefixes();
+    void copiesAreIsolated();
+    void randomEditsMatchStdMap();
+};
+
+void TestPersistentMap::insertFindRemoveWithSharedPrefixes() {
+    const std::vector<quint64> keys = collidingKeys();
+    Map map;
+    Reference reference;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        map.insert(keys[i], int(i));
+        reference[keys[i]] = int(i);
+        QVERIFY(sameContents(map, reference));
+    }
+
+    // Replacing keeps the size.
+    map.insert(keys.front(), -1);
+    reference[keys.front()] = -1;
+    QVERIFY(sameContents(map, reference));
+
+    // A key on a shared path that was never inserted.
+    QVERIFY(!map.contains(keys.back() ^ (quint64(1) << 40)));
+    QVERIFY(!map.remove(keys.back() ^ (quint64(1) << 40)));
+
+    // Removing folds the deep branches back; every other key stays reachable.
+    for (size_t i = 0; i < keys.size(); i += 2) {
+        QVERIFY(map.remove(keys[i]));
+        QVERIFY(!map.remove(keys[i]));
+        reference.erase(keys[i]);
+        QVERIFY(sameContents(map, reference));
+    }
+    for (size_t i = 1; i < keys.size(); i += 2) {
+        QVERIFY(map.remove(keys[i]));
+        reference.erase(keys[i]);
+        QVERIFY(sameContents(map, reference));
+    }
+    QVERIFY(map.isEmpty());
+}
+
+void TestPersistentMap::copiesAreIsolated() {
+    const std::vector<quint64> keys = collidingKeys();
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i) map.insert(keys[i], int(i));
+    Reference before;
+    map.forEach([&](quint64 key, int value) { before[key] = value; });
+
+    const Map snapshot = map;
+    map.insert(keys[0], 100);                          // replace
+    map.remove(keys[1]);                               // remove on a shared path
+    map.insert(keys[2] ^ (quint64(1) << 45), 200);     // split a deep leaf
+    QVERIFY(sameContents(snapshot, before));
+    QCOMPARE(*map.find(keys[0]), 100);
+    QVERIFY(!map.contains(keys[1]));
+    QCOMPARE(*map.find(keys[2] ^ (quint64(1) << 45)), 200);
+
+    // Edits to the copy do not reach the original either.
+    Map copy = snapshot;
+    copy.clear();
+    QVERIFY(copy.isEmpty());
+    QVERIFY(sameContents(snapshot, before));
+}
+
+void TestPersistentMap::randomEditsMatchStdMap() {
+    // Few distinct low bits, so most keys share several levels.
+    std::mt19937_64 random(23);
+    std::vector<quint64> pool;
+    for (int i = 0; i < 512; ++i) pool.push_back((random() & (~quint64(0) << 15)) | (random() & 3));
+
+    Map map;
+    Reference reference;
+    std::vector<std::pair<Map, Reference>> snapshots;
+    for (int op = 0; op < 20000; ++op) {
+        const quint64 key = pool[random() % pool.size()];
+        if (random() % 3 == 0) {
+            QCOMPARE(map.remove(key), reference.erase(key) == 1);
+        } else {
+            const int value = int(random() % 1000);
+            map.insert(key, value);
+            reference[key] = value;
+        }
+        if (op % 1000 == 0) snapshots.emplace_back(map, reference);
+    }
+    QVERIFY(sameContents(map, reference));
+    for (const auto& [snapshot, expected] : snapshots) QVERIFY(sameContents(snapshot, expected));
+}
+
+QTEST_GUILESS_MAIN(TestPersistentMap)
+#include "tst_persistentmap.moc"
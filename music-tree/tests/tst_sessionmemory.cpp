@@ -0,0 +1,108 @@
+// Loads 5k synthetic artists into a SessionManager and reports its
+// memoryEstimate() next to what the same artists take when each keeps its
+// full Artist record, releases included, as the session used to.
+#include <QtTest>
+#include "sessionmanager.h"
+
+namespace {
+
+constexpr int artistCount = 5000;
+constexpr int releasesPerArtist = 100;
+constexpr int artistsPerRelease = 5;  // every release is shared by this many artists
+constexpr int batchSize = 500;
+
+// Roughly the size of a Discogs profile.
+QString makeProfile(int artist) {
+    QString profile = QStringLiteral("Artist %1. ").arg(artist);
+    while (profile.size() < 1200) profile += QStringLiteral("Profile text for this artist. ");
+    return profile;
+}
+
+Artist makeArtist(int index) {
+    Artist artist;
+    artist.id = QString::number(100000 + index);
+    artist.name = QStringLiteral("Artist %1").arg(index);
+    artist.profile = makeProfile(index);
+    artist.resourceUrl = QStringLiteral("https://api.discogs.com/artists/") + artist.id;
+
+    // Artists of the same group share all their releases.
+    const int group = index / artistsPerRelease;
+    artist.releases.reserve(releasesPerArtist);
+    for (int j = 0; j < releasesPerArtist; ++j) {
+        ReleaseInfo r;
+        r.id = QString::number(5000000 + group * releasesPerArtist + j);
+        r.title = QStringLiteral("Release %1 of group %2").arg(j).arg(group);
+        r.artistName = artist.name;
+        r.year = 1970 + (group + j) % 50;
+        r.country = QStringLiteral("UK");
+        r.genre = QStringLiteral("Electronic");
+        r.style = QStringLiteral("Techno, House");
+        r.resourceUrl = QStringLiteral("https://api.discogs.com/releases/") + r.id;
+        r.dataQuality = QStringLiteral("Correct");
+        r.role = QStringLiteral("Main");
+        artist.releases.push_back(std::move(r));
+    }
+    return artist;
+}
+
+// An artist held whole, the way the session stored them before.
+qsizetype fullArtistBytes(const Artist& artist) {
+    qsizetype bytes = qsizetype(sizeof(Artist)) + stringHeapBytes(artist.id) + stringHeapBytes(artist.name)
+                      + stringHeapBytes(artist.profile) + stringHeapBytes(artist.resourceUrl)
+                      + qsizetype(artist.releases.capacity() * sizeof(ReleaseInfo));
+    for (const ReleaseInfo& r : artist.releases) {
+        for (const QString* s : {&r.id, &r.title, &r.artistName, &r.country, &r.genre, &r.style,
+                                 &r.resourceUrl, &r.dataQuality, &r.role}) {
+            bytes += stringHeapBytes(*s);
+        }
+    }
+    return bytes;
+}
+
+} // namespace
+
+class TestSessionMemory : public QObject {
+    Q_OBJECT
+
+private slots:
+    void fiveThousandArtists();
+};
+
+void TestSessionMemory::fiveThousandArtists() {
+    SessionManager session;
+    qsizetype fullBytes = 0;
+
+    // In batches, so the inputs never all exist at once.
+    for (int first = 0; first < artistCount; first += batchSize) {
+        std::vector<Artist> batch;
+        batch.reserve(batchSize);
+        for (int i = first; i < first + batchSize; ++i) {
+            batch.push_back(makeArtist(i));
+            fullBytes += fullArtistBytes(batch.back());
+        }
+        session.addArtists(batch);
+    }
+
+    QCOMPARE(session.artistCount(), artistCount);
+    QCOMPARE(session.releases().size(), artistCount / artistsPerRelease * releasesPerArtist);
+
+    const ReleaseKey key = session.releases().find(QStringLiteral("5000001"));
+    QCOMPARE(session.releases().summary(key).title, QStringLiteral("Release 1 of group 0"));
+    QCOMPARE(session.releases().summary(key).year, 1971);
+    QCOMPARE(session.getArtistsForRelease(QStringLiteral("5000001")).size(), qsizetype(artistsPerRelease));
+
+    // The estimate covers the whole session (ids, release store, release
+    // index, collaborations); the full records alone are compared with it.
+    const qsizetype sessionBytes = session.memoryEstimate();
+    qInfo("%d artists, %d releases each, each release shared by %d artists",
+          artistCount, releasesPerArtist, artistsPerRelease);
+    qInfo("session memoryEstimate(): %.1f MB", sessionBytes / (1024.0 * 1024.0));
+    qInfo("full artist records alone: %.1f MB", fullBytes / (1024.0 * 1024.0));
+    QVERIFY(sessionBytes < fullBytes);
+
+    session.clear();
+    QCOMPARE(session.releases().size(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestSessionMemory)
+#include "tst_sessionmemory.moc"
@@ -0,0 +1,70 @@
+// SlotMap handles: a removed value's handle stays dead, also once its slot
+// holds a new value.
+#include <QtTest>
+#include "slotmap.h"
+
+class TestSlotMap : public QObject {
+    Q_OBJECT
+
+private slots:
+    void staleHandleAfterRemove();
+    void staleHandleAfterReuse();
+    void staleHandlesAfterClear();
+};
+
+void TestSlotMap::staleHandleAfterRemove() {
+    SlotMap<QString> map;
+    const auto a = map.insert(QStringLiteral("a"));
+    const auto b = map.insert(QStringLiteral("b"));
+    QCOMPARE(map.size(), 2);
+
+    QVERIFY(map.remove(a));
+    QVERIFY(!map.contains(a));
+    QVERIFY(!map.get(a));
+    QVERIFY(!map.remove(a));
+    QCOMPARE(map.size(), 1);
+
+    QVERIFY(map.contains(b));
+    QCOMPARE(*map.get(b), QStringLiteral("b"));
+
+    using Handle = SlotMap<QString>::Handle;
+    QVERIFY(Handle().isNull());
+    QVERIFY(!map.contains(Handle()));
+}
+
+void TestSlotMap::staleHandleAfterReuse() {
+    SlotMap<QString> map;
+    const auto old = map.insert(QStringLiteral("old"));
+    QVERIFY(map.remove(old));
+
+    // The freed slot is reused with a new generation.
+    const auto fresh = map.insert(QStringLiteral("new"));
+    QCOMPARE(fresh.index, old.index);
+    QVERIFY(fresh != old);
+    QVERIFY(!map.contains(old));
+    QVERIFY(!map.get(old));
+    QVERIFY(!map.remove(old));
+    QCOMPARE(*map.get(fresh), QStringLiteral("new"));
+    QCOMPARE(map.size(), 1);
+}
+
+void TestSlotMap::staleHandlesAfterClear() {
+    SlotMap<int> map;
+    std::vector<SlotMap<int>::Handle> handles;
+    for (int i = 0; i < 8; ++i) handles.push_back(map.insert(i));
+    QVERIFY(map.remove(handles[3]));
+
+    map.clear();
+    QCOMPARE(map.size(), 0);
+    for (const auto& handle : handles) QVERIFY(!map.contains(handle));
+
+    // Every slot is reused, none of them revives an old handle.
+    for (int i = 0; i < 8; ++i) {
+        const auto handle = map.insert(100 + i);
+        QCOMPARE(*map.get(handle), 100 + i);
+    }
+    for (const auto& handle : handles) QVERIFY(!map.get(handle));
+}
+
+QTEST_GUILESS_MAIN(TestSlotMap)
+#include "tst_slotmap.moc"
@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+
+// Single-producer / single-consumer triple buffer.
+// The producer fills back() and publish()es it; the consumer calls acquire()
+// to pick up the newest published slot and reads front() until the next
+// acquire(). Neither side ever blocks or sees a half-written value.
+template <typename T>
+class TripleBuffer {
+public:
+    T& back() { return m_slots[m_back]; }
+    const T& front() const { return m_slots[m_front]; }
+
+    // Producer: hand the back slot over and take the previously ready one.
+    void publish() {
+        const int previous = m_ready.exchange(m_back | freshBit, std::memory_order_acq_rel);
+        m_back = previous & indexMask;
+    }
+
+    // Consumer: swap in the newest published slot. Returns false if nothing
+    // new was published since the last call.
+    bool acquire() {
+        if (!(m_ready.load(std::memory_order_relaxed) & freshBit)) return false;
+        const int ready = m_ready.exchange(m_front, std::memory_order_acq_rel);
+        m_front = ready & indexMask;
+        return true;
+    }
+
+private:
+    static constexpr int freshBit = 4;
+    static constexpr int indexMask = 3;
+
+    T m_slots[3];
+    int m_back = 0;
+    int m_front = 1;
+    std::atomic<int> m_ready{2};
+};